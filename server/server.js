@@ -1,6 +1,7 @@
 const express = require('express');
 const cors = require('cors');
-const { exec } = require('child_process');
+const { spawn } = require('child_process');
+const readline = require('readline');
 const path = require('path');
 
 const app = express();
@@ -17,24 +18,60 @@ app.use(express.static(webPath));
 const CLI_PATH = path.resolve(__dirname, '..', 'chess_cli.exe');
 console.log(`🎮 Chess CLI: ${CLI_PATH}`);
 
+// The chess CLI runs as one long-lived process in "serve" mode, answering
+// one command per line. Keeping it alive lets the AI ponder between requests.
+let engine = null;
+const pending = [];
+
+function startEngine() {
+    engine = spawn(CLI_PATH, ['serve']);
+
+    readline.createInterface({ input: engine.stdout }).on('line', (line) => {
+        // Only JSON lines are replies; anything else must not take a request's
+        // place, or every later reply would answer the wrong request
+        let result;
+        try {
+            result = JSON.parse(line);
+        } catch (e) {
+            console.error(`Chess CLI: ${line}`);
+            return;
+        }
+
+        const request = pending.shift();
+        if (!request) return;
+
+        if (result.error) {
+            request.reject(result);
+        } else {
+            request.resolve(result);
+        }
+    });
+    // Drain diagnostics so a full stderr pipe can never block the engine
+    readline.createInterface({ input: engine.stderr }).on('line', (line) => {
+        console.error(`Chess CLI: ${line}`);
+    });
+
+    engine.on('exit', () => {
+        engine = null;
+        while (pending.length > 0) {
+            pending.shift().reject({ error: 'Chess engine exited' });
+        }
+    });
+    engine.on('error', (error) => {
+        console.error(`Chess CLI failed: ${error.message}`);
+    });
+}
+
 // Helper function to execute chess commands
 function executeChessCommand(command, args = []) {
     return new Promise((resolve, reject) => {
-        const fullCommand = `"${CLI_PATH}" ${command} ${args.join(' ')}`;
-        
-        exec(fullCommand, (error, stdout, stderr) => {
-            if (error) {
-                reject({ error: stderr || error.message });
-                return;
-            }
-            
-            try {
-                const result = JSON.parse(stdout);
-                resolve(result);
-            } catch (e) {
-                reject({ error: 'Invalid JSON response' });
-            }
-        });
+        if (!engine) {
+            startEngine();
+        }
+
+        // Replies come back in order, so each one answers the oldest request
+        pending.push({ resolve, reject });
+        engine.stdin.write(`${command} ${args.join(' ')}\n`);
     });
 }
 
@@ -75,8 +112,13 @@ app.post('/api/newgame', async (req, res) => {
 // Set AI difficulty
 app.post('/api/setai', async (req, res) => {
     try {
-        const { difficulty } = req.body;
-        const result = await executeChessCommand('setai', [difficulty]);
+        const { difficulty, timeMs, nodes, threads } = req.body;
+        const args = [difficulty];
+        // Optional search budget per AI move and search thread count
+        if (timeMs !== undefined || nodes !== undefined || threads !== undefined) {
+            args.push(parseInt(timeMs, 10) || 0, parseInt(nodes, 10) || 0, parseInt(threads, 10) || 1);
+        }
+        const result = await executeChessCommand('setai', args);
         res.json(result);
     } catch (error) {
         res.status(500).json(error);
@@ -0,0 +1,297 @@
+#include "Attacks.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#endif
+
+Bitboard Attacks::knightTable[64];
+Bitboard Attacks::kingTable[64];
+Bitboard Attacks::pawnTable[2][64];
+Bitboard Attacks::rayTable[Attacks::DIRECTION_COUNT][64];
+Bitboard Attacks::betweenTable[64][64];
+Bitboard Attacks::lineTable[64][64];
+
+Attacks::Magic Attacks::bishopMagics[64];
+Attacks::Magic Attacks::rookMagics[64];
+Bitboard Attacks::bishopTable[0x1480];
+Bitboard Attacks::rookTable[0x19000];
+bool Attacks::pextEnabled = false;
+
+namespace {
+
+const int DIRECTION_ROW[8] = {1, 0, 1, 1, -1, 0, -1, -1};
+const int DIRECTION_COL[8] = {0, 1, 1, -1, 0, -1, -1, 1};
+
+Bitboard offsetsToBitboard(int square, const int rowOffsets[], const int colOffsets[], int count) {
+    Bitboard result = EMPTY_BB;
+    int row = square / 8;
+    int col = square % 8;
+    for (int i = 0; i < count; i++) {
+        int r = row + rowOffsets[i];
+        int c = col + colOffsets[i];
+        if (r >= 0 && r < 8 && c >= 0 && c < 8) {
+            result |= squareBB(squareIndex(r, c));
+        }
+    }
+    return result;
+}
+
+// Magic multipliers found by the search below, so startup only has to verify them
+const Bitboard BISHOP_MAGICS[64] = {
+    0x40106000A1160020ULL, 0x0020010250810120ULL, 0x2010010220280081ULL, 0x002806004050C040ULL,
+    0x0002021018000000ULL, 0x2001112010000400ULL, 0x0881010120218080ULL, 0x1030820110010500ULL,
+    0x0000120222042400ULL, 0x2000020404040044ULL, 0x8000480094208000ULL, 0x0003422A02000001ULL,
+    0x000A220210100040ULL, 0x8004820202226000ULL, 0x0018234854100800ULL, 0x0100004042101040ULL,
+    0x0004001004082820ULL, 0x0010000810010048ULL, 0x1014004208081300ULL, 0x2080818802044202ULL,
+    0x0040880C00A00100ULL, 0x0080400200522010ULL, 0x0001000188180B04ULL, 0x0080249202020204ULL,
+    0x1004400004100410ULL, 0x00013100A0022206ULL, 0x2148500001040080ULL, 0x4241080011004300ULL,
+    0x4020848004002000ULL, 0x10101380D1004100ULL, 0x0008004422020284ULL, 0x01010A1041008080ULL,
+    0x0808080400082121ULL, 0x0808080400082121ULL, 0x0091128200100C00ULL, 0x0202200802010104ULL,
+    0x8C0A020200440085ULL, 0x01A0008080B10040ULL, 0x0889520080122800ULL, 0x100902022202010AULL,
+    0x04081A0816002000ULL, 0x0000681208005000ULL, 0x8170840041008802ULL, 0x0A00004200810805ULL,
+    0x0830404408210100ULL, 0x2602208106006102ULL, 0x1048300680802628ULL, 0x2602208106006102ULL,
+    0x0602010120110040ULL, 0x0941010801043000ULL, 0x000040440A210428ULL, 0x0008240020880021ULL,
+    0x0400002012048200ULL, 0x00AC102001210220ULL, 0x0220021002009900ULL, 0x84440C080A013080ULL,
+    0x0001008044200440ULL, 0x0004C04410841000ULL, 0x2000500104011130ULL, 0x1A0C010011C20229ULL,
+    0x0044800112202200ULL, 0x0434804908100424ULL, 0x0300404822C08200ULL, 0x48081010008A2A80ULL
+};
+
+const Bitboard ROOK_MAGICS[64] = {
+    0x0A80004000801220ULL, 0x8040004010002008ULL, 0x2080200010008008ULL, 0x1100100008210004ULL,
+    0xC200209084020008ULL, 0x2100010004000208ULL, 0x0400081000822421ULL, 0x0200010422048844ULL,
+    0x0800800080400024ULL, 0x0001402000401000ULL, 0x3000801000802001ULL, 0x4400800800100083ULL,
+    0x0904802402480080ULL, 0x4040800400020080ULL, 0x0018808042000100ULL, 0x4040800080004100ULL,
+    0x0040048001458024ULL, 0x00A0004000205000ULL, 0x3100808010002000ULL, 0x4825010010000820ULL,
+    0x5004808008000401ULL, 0x2024818004000A00ULL, 0x0005808002000100ULL, 0x2100060004806104ULL,
+    0x0080400880008421ULL, 0x4062220600410280ULL, 0x010A004A00108022ULL, 0x0000100080080080ULL,
+    0x0021000500080010ULL, 0x0044000202001008ULL, 0x0000100400080102ULL, 0xC020128200040545ULL,
+    0x0080002000400040ULL, 0x0000804000802004ULL, 0x0000120022004080ULL, 0x010A386103001001ULL,
+    0x9010080080800400ULL, 0x8440020080800400ULL, 0x0004228824001001ULL, 0x000000490A000084ULL,
+    0x0080002000504000ULL, 0x200020005000C000ULL, 0x0012088020420010ULL, 0x0010010080080800ULL,
+    0x0085001008010004ULL, 0x0002000204008080ULL, 0x0040413002040008ULL, 0x0000304081020004ULL,
+    0x0080204000800080ULL, 0x3008804000290100ULL, 0x1010100080200080ULL, 0x2008100208028080ULL,
+    0x5000850800910100ULL, 0x8402019004680200ULL, 0x0120911028020400ULL, 0x0000008044010200ULL,
+    0x0020850200244012ULL, 0x0020850200244012ULL, 0x0000102001040841ULL, 0x140900040A100021ULL,
+    0x000200282410A102ULL, 0x000200282410A102ULL, 0x000200282410A102ULL, 0x4048240043802106ULL
+};
+
+// xorshift64* generator used to search for magic numbers, seeded per rank
+// with values known to find all magics quickly
+class MagicRandom {
+private:
+    uint64_t state;
+
+public:
+    MagicRandom(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 2685821657736338717ULL;
+    }
+
+    // Few set bits make better magic candidates
+    uint64_t sparse() {
+        return next() & next() & next();
+    }
+};
+
+} // namespace
+
+// Fills the tables once before main runs
+struct AttacksInitializer {
+    AttacksInitializer() {
+        Attacks::init();
+    }
+};
+
+static AttacksInitializer attacksInitializer;
+
+void Attacks::init() {
+    const int knightRows[8] = {-2, -2, -1, -1, 1, 1, 2, 2};
+    const int knightCols[8] = {-1, 1, -2, 2, -2, 2, -1, 1};
+    const int kingRows[8] = {-1, -1, -1, 0, 0, 1, 1, 1};
+    const int kingCols[8] = {-1, 0, 1, -1, 1, -1, 0, 1};
+    const int whitePawnRows[2] = {1, 1};
+    const int blackPawnRows[2] = {-1, -1};
+    const int pawnCols[2] = {-1, 1};
+
+    for (int square = 0; square < 64; square++) {
+        knightTable[square] = offsetsToBitboard(square, knightRows, knightCols, 8);
+        kingTable[square] = offsetsToBitboard(square, kingRows, kingCols, 8);
+        pawnTable[0][square] = offsetsToBitboard(square, whitePawnRows, pawnCols, 2);
+        pawnTable[1][square] = offsetsToBitboard(square, blackPawnRows, pawnCols, 2);
+
+        for (int target = 0; target < 64; target++) {
+            betweenTable[square][target] = EMPTY_BB;
+            lineTable[square][target] = EMPTY_BB;
+        }
+    }
+
+    for (int square = 0; square < 64; square++) {
+        for (int dir = 0; dir < DIRECTION_COUNT; dir++) {
+            Bitboard ray = EMPTY_BB;
+            int r = square / 8 + DIRECTION_ROW[dir];
+            int c = square % 8 + DIRECTION_COL[dir];
+            while (r >= 0 && r < 8 && c >= 0 && c < 8) {
+                ray |= squareBB(squareIndex(r, c));
+                r += DIRECTION_ROW[dir];
+                c += DIRECTION_COL[dir];
+            }
+            rayTable[dir][square] = ray;
+        }
+    }
+
+    for (int square = 0; square < 64; square++) {
+        for (int dir = 0; dir < DIRECTION_COUNT; dir++) {
+            int opposite = (dir + 4) % DIRECTION_COUNT;
+            Bitboard fullLine = rayTable[dir][square] | rayTable[opposite][square] | squareBB(square);
+
+            Bitboard passed = EMPTY_BB;
+            int r = square / 8 + DIRECTION_ROW[dir];
+            int c = square % 8 + DIRECTION_COL[dir];
+            while (r >= 0 && r < 8 && c >= 0 && c < 8) {
+                int target = squareIndex(r, c);
+                betweenTable[square][target] = passed;
+                lineTable[square][target] = fullLine;
+                passed |= squareBB(target);
+                r += DIRECTION_ROW[dir];
+                c += DIRECTION_COL[dir];
+            }
+        }
+    }
+
+#if defined(__BMI2__)
+    pextEnabled = true;
+#else
+    pextEnabled = cpuHasPext();
+#endif
+
+    const int bishopDirections[4] = {NORTH_EAST, NORTH_WEST, SOUTH_WEST, SOUTH_EAST};
+    const int rookDirections[4] = {NORTH, EAST, SOUTH, WEST};
+    initMagics(bishopMagics, bishopTable, bishopDirections, BISHOP_MAGICS);
+    initMagics(rookMagics, rookTable, rookDirections, ROOK_MAGICS);
+}
+
+// Builds the attack table of one slider type. Ray scans give the reference attacks
+// for every blocker subset; with PEXT the subset index is direct, otherwise the
+// known magic is verified (or a new one searched) so all subsets map without
+// harmful collisions.
+void Attacks::initMagics(Magic magics[], Bitboard table[], const int directions[4], const Bitboard knownMagics[64]) {
+    static Bitboard occupancy[4096];
+    static Bitboard reference[4096];
+    static int epoch[4096];
+    const uint64_t seeds[8] = {728, 10316, 55013, 32803, 12281, 15100, 16645, 255};
+
+    int attempt = 0;
+    for (int i = 0; i < 4096; i++) {
+        epoch[i] = 0;
+    }
+
+    Bitboard* next = table;
+    for (int square = 0; square < 64; square++) {
+        Magic& m = magics[square];
+
+        // Edge squares never block anything further along the ray
+        Bitboard edges = ((RANK_1_BB | RANK_8_BB) & ~(RANK_1_BB << (8 * (square / 8)))) |
+                         ((FILE_A_BB | FILE_H_BB) & ~(FILE_A_BB << (square % 8)));
+
+        Bitboard fullAttacks = EMPTY_BB;
+        for (int i = 0; i < 4; i++) {
+            fullAttacks |= rayTable[directions[i]][square];
+        }
+        m.mask = fullAttacks & ~edges;
+        m.shift = 64 - popCount(m.mask);
+        m.magic = 0;
+        m.attacks = next;
+
+        // Carry-Rippler walk over every subset of the mask
+        int size = 0;
+        Bitboard subset = EMPTY_BB;
+        do {
+            occupancy[size] = subset;
+            reference[size] = EMPTY_BB;
+            for (int i = 0; i < 4; i++) {
+                reference[size] |= rayAttacks(directions[i], square, subset);
+            }
+            if (pextEnabled) {
+                m.attacks[pext(subset, m.mask)] = reference[size];
+            }
+            size++;
+            subset = (subset - m.mask) & m.mask;
+        } while (subset);
+
+        next += size;
+        if (pextEnabled) {
+            continue;
+        }
+
+        MagicRandom random(seeds[square / 8]);
+        bool firstTry = true;
+        for (int i = 0; i < size; ) {
+            if (firstTry) {
+                m.magic = knownMagics[square];
+                firstTry = false;
+            } else {
+                do {
+                    m.magic = random.sparse();
+                } while (popCount((m.magic * m.mask) >> 56) < 6);
+            }
+
+            for (attempt++, i = 0; i < size; i++) {
+                unsigned index = static_cast<unsigned>(((occupancy[i] & m.mask) * m.magic) >> m.shift);
+                if (epoch[index] < attempt) {
+                    epoch[index] = attempt;
+                    m.attacks[index] = reference[i];
+                } else if (m.attacks[index] != reference[i]) {
+                    break;
+                }
+            }
+        }
+    }
+}
+
+#if defined(__GNUC__) && !defined(__BMI2__) && (defined(__x86_64__) || defined(__i386__))
+__attribute__((target("bmi2")))
+#endif
+Bitboard Attacks::pext(Bitboard value, Bitboard mask) {
+#if (defined(_MSC_VER) && defined(_M_X64)) || (defined(__GNUC__) && defined(__x86_64__))
+    return _pext_u64(value, mask);
+#else
+    Bitboard result = EMPTY_BB;
+    for (Bitboard bit = 1; mask; bit <<= 1) {
+        if (value & mask & (0 - mask)) {
+            result |= bit;
+        }
+        mask &= mask - 1;
+    }
+    return result;
+#endif
+}
+
+bool Attacks::cpuHasPext() {
+#if defined(_MSC_VER) && defined(_M_X64)
+    int info[4];
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 8)) != 0;
+#elif defined(__GNUC__) && defined(__x86_64__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("bmi2");
+#else
+    return false;
+#endif
+}
+
+// Attacks along one ray, cut off at the first blocker (which is included)
+Bitboard Attacks::rayAttacks(int direction, int square, Bitboard occupied) {
+    Bitboard attacks = rayTable[direction][square];
+    Bitboard blockers = attacks & occupied;
+    if (blockers) {
+        int blocker = (direction < SOUTH) ? lsbIndex(blockers) : msbIndex(blockers);
+        attacks ^= rayTable[direction][blocker];
+    }
+    return attacks;
+}
@@ -0,0 +1,103 @@
+#ifndef ATTACKS_H
+#define ATTACKS_H
+
+#include "../utils/Types.h"
+#include "../utils/Bitboard.h"
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+// Precomputed attack sets for every piece type, indexed by square.
+// Sliding pieces use magic bitboards, or BMI2 PEXT when the CPU supports it.
+class Attacks {
+public:
+    static Bitboard knightAttacks(int square) {
+        return knightTable[square];
+    }
+
+    static Bitboard kingAttacks(int square) {
+        return kingTable[square];
+    }
+
+    // Squares a pawn of the given color attacks from square
+    static Bitboard pawnAttacks(Color color, int square) {
+        return pawnTable[color == WHITE ? 0 : 1][square];
+    }
+
+    static Bitboard bishopAttacks(int square, Bitboard occupied) {
+        return bishopMagics[square].attacks[bishopMagics[square].index(occupied)];
+    }
+
+    static Bitboard rookAttacks(int square, Bitboard occupied) {
+        return rookMagics[square].attacks[rookMagics[square].index(occupied)];
+    }
+
+    static Bitboard queenAttacks(int square, Bitboard occupied) {
+        return bishopAttacks(square, occupied) | rookAttacks(square, occupied);
+    }
+
+    // Squares strictly between two aligned squares, empty if not aligned
+    static Bitboard between(int from, int to) {
+        return betweenTable[from][to];
+    }
+
+    // Whole board line through two aligned squares, empty if not aligned
+    static Bitboard line(int from, int to) {
+        return lineTable[from][to];
+    }
+
+    static bool usesPext() {
+        return pextEnabled;
+    }
+
+private:
+    // Directions 0-3 increase the square index, direction + 4 is the opposite one
+    enum Direction {
+        NORTH, EAST, NORTH_EAST, NORTH_WEST,
+        SOUTH, WEST, SOUTH_WEST, SOUTH_EAST,
+        DIRECTION_COUNT
+    };
+
+    struct Magic {
+        Bitboard mask;
+        Bitboard magic;
+        Bitboard* attacks;
+        unsigned shift;
+
+        unsigned index(Bitboard occupied) const {
+#if defined(__BMI2__)
+            return static_cast<unsigned>(_pext_u64(occupied, mask));
+#else
+            if (pextEnabled) {
+                return static_cast<unsigned>(pext(occupied, mask));
+            }
+            return static_cast<unsigned>(((occupied & mask) * magic) >> shift);
+#endif
+        }
+    };
+
+    static Bitboard knightTable[64];
+    static Bitboard kingTable[64];
+    static Bitboard pawnTable[2][64];
+    static Bitboard rayTable[DIRECTION_COUNT][64];
+    static Bitboard betweenTable[64][64];
+    static Bitboard lineTable[64][64];
+
+    static Magic bishopMagics[64];
+    static Magic rookMagics[64];
+    static Bitboard bishopTable[0x1480];
+    static Bitboard rookTable[0x19000];
+    static bool pextEnabled;
+
+    static Bitboard rayAttacks(int direction, int square, Bitboard occupied);
+    static Bitboard pext(Bitboard value, Bitboard mask);
+    static bool cpuHasPext();
+    static void initMagics(Magic magics[], Bitboard table[], const int directions[4],
+                           const Bitboard knownMagics[64]);
+
+    static void init();
+    friend struct AttacksInitializer;
+};
+
+#endif // ATTACKS_H
@@ -1,6 +1,9 @@
 #include "Board.h"
+#include "Zobrist.h"
+#include "../utils/PieceSquareTables.h"
 #include <iostream>
 #include <iomanip>
+#include <cstdlib>
 using namespace std;
 
 Board::Board() {
@@ -11,27 +14,44 @@ void Board::initializeBoard() {
     clearBoard();
 
     for(int col = 0; col < 8; ++col) {
-        board[1][col] = Piece(PieceType::PAWN, Color::WHITE);
-        board[6][col] = Piece(PieceType::PAWN, Color::BLACK);
+        setPiece(1, col, Piece(PieceType::PAWN, Color::WHITE));
+        setPiece(6, col, Piece(PieceType::PAWN, Color::BLACK));
     }
 
-    board[0][0] = Piece(ROOK, WHITE);
-    board[0][1] = Piece(KNIGHT, WHITE);
-    board[0][2] = Piece(BISHOP, WHITE);
-    board[0][3] = Piece(QUEEN, WHITE);
-    board[0][4] = Piece(KING, WHITE);
-    board[0][5] = Piece(BISHOP, WHITE);
-    board[0][6] = Piece(KNIGHT, WHITE);
-    board[0][7] = Piece(ROOK, WHITE);
+    setPiece(0, 0, Piece(ROOK, WHITE));
+    setPiece(0, 1, Piece(KNIGHT, WHITE));
+    setPiece(0, 2, Piece(BISHOP, WHITE));
+    setPiece(0, 3, Piece(QUEEN, WHITE));
+    setPiece(0, 4, Piece(KING, WHITE));
+    setPiece(0, 5, Piece(BISHOP, WHITE));
+    setPiece(0, 6, Piece(KNIGHT, WHITE));
+    setPiece(0, 7, Piece(ROOK, WHITE));
+
+    setPiece(7, 0, Piece(ROOK, BLACK));
+    setPiece(7, 1, Piece(KNIGHT, BLACK));
+    setPiece(7, 2, Piece(BISHOP, BLACK));
+    setPiece(7, 3, Piece(QUEEN, BLACK));
+    setPiece(7, 4, Piece(KING, BLACK));
+    setPiece(7, 5, Piece(BISHOP, BLACK));
+    setPiece(7, 6, Piece(KNIGHT, BLACK));
+    setPiece(7, 7, Piece(ROOK, BLACK));
+}
 
-    board[7][0] = Piece(ROOK, BLACK);
-    board[7][1] = Piece(KNIGHT, BLACK);
-    board[7][2] = Piece(BISHOP, BLACK);
-    board[7][3] = Piece(QUEEN, BLACK);
-    board[7][4] = Piece(KING, BLACK);
-    board[7][5] = Piece(BISHOP, BLACK);
-    board[7][6] = Piece(KNIGHT, BLACK);
-    board[7][7] = Piece(ROOK, BLACK);
+void Board::clearBitboards() {
+    for(int color = 0; color < 3; color++) {
+        for(int type = 0; type < 7; type++) {
+            pieceBB[color][type] = EMPTY_BB;
+            pieceCount[color][type] = 0;
+        }
+        colorBB[color] = EMPTY_BB;
+        colorCount[color] = 0;
+        kingSquare[color] = -1;
+    }
+    occupiedBB = EMPTY_BB;
+    materialScore = 0;
+    middlegameScore = 0;
+    endgameScore = 0;
+    phase = 0;
 }
 
 void Board::clearBoard() {
@@ -40,6 +60,11 @@ void Board::clearBoard() {
             board[row][col] = Piece();
         }
     }
+    clearBitboards();
+    enPassantSquare = -1;
+    sideToMove = WHITE;
+    castlingRights = 0;
+    zobristKey = Zobrist::sideKey();
     whiteCaptured.clear();
     blackCaptured.clear();
 }
@@ -58,16 +83,89 @@ Piece Board::getPiece(int row, int col) const {
 }
 
 void Board::setPiece(Position pos, Piece piece) {
-    if(isPositionValid(pos)) {
-        board[pos.row][pos.col] = piece;
-    }
+    setPiece(pos.row, pos.col, piece);
 }
 void Board::setPiece(int row, int col, Piece piece) {
-    if(isPositionValid(row, col)) {
-        board[row][col] = piece;
+    if(!isPositionValid(row, col)) {
+        return;
+    }
+
+    int square = squareIndex(row, col);
+    Bitboard bit = squareBB(square);
+    Piece old = board[row][col];
+    if(!old.isEmpty() && old.getColor() != NONE) {
+        pieceBB[old.getColor()][old.getType()] &= ~bit;
+        colorBB[old.getColor()] &= ~bit;
+        occupiedBB &= ~bit;
+        zobristKey ^= Zobrist::pieceKey(old.getType(), old.getColor(), square);
+        pieceCount[old.getColor()][old.getType()]--;
+        int sign = (old.getColor() == WHITE) ? 1 : -1;
+        materialScore -= sign * PieceSquareTables::value(old.getType());
+        middlegameScore -= sign * PieceSquareTables::middlegame(old.getType(), old.getColor(), square);
+        endgameScore -= sign * PieceSquareTables::endgame(old.getType(), old.getColor(), square);
+        phase -= PieceSquareTables::phase(old.getType());
+        colorCount[old.getColor()]--;
+        if(old.getType() == KING && kingSquare[old.getColor()] == square) {
+            Bitboard kings = pieceBB[old.getColor()][KING];
+            kingSquare[old.getColor()] = kings ? lsbIndex(kings) : -1;
+        }
+    }
+
+    board[row][col] = piece;
+    if(!piece.isEmpty() && piece.getColor() != NONE) {
+        pieceBB[piece.getColor()][piece.getType()] |= bit;
+        colorBB[piece.getColor()] |= bit;
+        occupiedBB |= bit;
+        zobristKey ^= Zobrist::pieceKey(piece.getType(), piece.getColor(), square);
+        pieceCount[piece.getColor()][piece.getType()]++;
+        int sign = (piece.getColor() == WHITE) ? 1 : -1;
+        materialScore += sign * PieceSquareTables::value(piece.getType());
+        middlegameScore += sign * PieceSquareTables::middlegame(piece.getType(), piece.getColor(), square);
+        endgameScore += sign * PieceSquareTables::endgame(piece.getType(), piece.getColor(), square);
+        phase += PieceSquareTables::phase(piece.getType());
+        colorCount[piece.getColor()]++;
+        if(piece.getType() == KING) {
+            kingSquare[piece.getColor()] = square;
+        }
+    }
+
+    // Castling rights only depend on the king and rook home squares
+    if((row == 0 || row == 7) && (col == 0 || col == 4 || col == 7)) {
+        updateCastlingRights();
     }
 }
 
+void Board::updateCastlingRights() {
+    int rights = 0;
+    const int homeRows[2] = {0, 7};
+    const Color colors[2] = {WHITE, BLACK};
+    const int kingside[2] = {Zobrist::WHITE_KINGSIDE, Zobrist::BLACK_KINGSIDE};
+    const int queenside[2] = {Zobrist::WHITE_QUEENSIDE, Zobrist::BLACK_QUEENSIDE};
+
+    for(int i = 0; i < 2; i++) {
+        Piece king = board[homeRows[i]][4];
+        if(king.getType() != KING || king.getColor() != colors[i] || king.getHasMoved()) {
+            continue;
+        }
+        Piece kingsideRook = board[homeRows[i]][7];
+        Piece queensideRook = board[homeRows[i]][0];
+        if(kingsideRook.getType() == ROOK && kingsideRook.getColor() == colors[i] && !kingsideRook.getHasMoved()) {
+            rights |= kingside[i];
+        }
+        if(queensideRook.getType() == ROOK && queensideRook.getColor() == colors[i] && !queensideRook.getHasMoved()) {
+            rights |= queenside[i];
+        }
+    }
+
+    zobristKey ^= Zobrist::castlingKey(castlingRights) ^ Zobrist::castlingKey(rights);
+    castlingRights = rights;
+}
+
+void Board::setEnPassantSquare(int square) {
+    zobristKey ^= Zobrist::enPassantKey(enPassantSquare) ^ Zobrist::enPassantKey(square);
+    enPassantSquare = square;
+}
+
 bool Board::isPositionValid(Position pos) const {
     return pos.isValid();
 }
@@ -78,14 +176,13 @@ bool Board::isSquareEmpty(Position pos) const {
     if(!isPositionValid(pos)) {
         return false;
     }
-    return board[pos.row][pos.col].isEmpty();
+    return (occupiedBB & squareBB(squareIndex(pos))) == EMPTY_BB;
 }
 bool Board::isSquareOccupiedByColor(Position pos, Color color) const {
     if(!isPositionValid(pos)) {
         return false;
     }
-    Piece piece = board[pos.row][pos.col];
-    return !piece.isEmpty() && piece.getColor() == color;
+    return (getPieces(color) & squareBB(squareIndex(pos))) != EMPTY_BB;
 }
 
 bool Board::movePiece(Position from, Position to) {
@@ -102,62 +199,178 @@ bool Board::movePiece(Position from, Position to) {
         addCapturedPiece(capturedPiece);
     }
 
+    piece.setHasMoved(true);
     setPiece(to, piece);
     setPiece(from, Piece());
-
-    board[to.row][to.col].setHasMoved(true);
     return true;
 }
 
 bool Board::executeMove(const Move& move) {
+    MoveUndo undo;
+    if(!makeMove(move, undo)) {
+        return false;
+    }
+    addCapturedPiece(undo.captured);
+    return true;
+}
+
+bool Board::makeMove(const Move& move, MoveUndo& undo) {
     if(!move.isValid()) {
         return false;
     }
+    return makeMove(PackedMove::fromMove(move), undo);
+}
+
+void Board::unmakeMove(const Move& move, const MoveUndo& undo) {
+    unmakeMove(PackedMove::fromMove(move), undo);
+}
+
+bool Board::makeMove(PackedMove move, MoveUndo& undo) {
+    if(move.isNull()) {
+        return false;
+    }
 
     Position from = move.getFrom();
     Position to = move.getTo();
+    Piece piece = getPiece(from);
+    if(piece.isEmpty()) {
+        return false;
+    }
+
+    undo.captured = getPiece(to);
+    undo.capturedPos = to;
+    undo.movedHadMoved = piece.getHasMoved();
+    undo.rookHadMoved = false;
+    undo.enPassantSquare = enPassantSquare;
+    undo.sideToMove = sideToMove;
+    setEnPassantSquare(-1);
+    setSideToMove(oppositeColor(piece.getColor()));
 
     if(move.isCastlingMove()) {
-        movePiece(from, to);
-
-        if(to.col> from.col) {
-            Position rookFrom(from.row, 7);
-            Position rookTo(from.row, 5);
-            movePiece(rookFrom, rookTo);
-        } else {
-            Position rookFrom(from.row, 0);
-            Position rookTo(from.row, 3);
-            movePiece(rookFrom, rookTo);
+        int rookFromCol = (to.col > from.col) ? 7 : 0;
+        int rookToCol = (to.col > from.col) ? 5 : 3;
+        Piece rook = getPiece(from.row, rookFromCol);
+        undo.rookHadMoved = rook.getHasMoved();
+
+        piece.setHasMoved(true);
+        setPiece(from, Piece());
+        setPiece(to, piece);
+
+        if(!rook.isEmpty()) {
+            rook.setHasMoved(true);
+            setPiece(from.row, rookFromCol, Piece());
+            setPiece(from.row, rookToCol, rook);
         }
         return true;
     }
 
     if(move.isEnPassantMove()) {
-        movePiece(from, to);
-
-        Position capturedPawnPos(from.row, to.col);
-        Piece capturedPawn = getPiece(capturedPawnPos);
-        addCapturedPiece(capturedPawn);
-        setPiece(capturedPawnPos, Piece());
-        return true;
+        undo.capturedPos = Position(from.row, to.col);
+        undo.captured = getPiece(undo.capturedPos);
+        setPiece(undo.capturedPos, Piece());
     }
 
     if(move.isPromotionMove()) {
-        Piece piece = getPiece(from);
+        piece = Piece(move.getPromotionPiece(), piece.getColor());
+    }
+    piece.setHasMoved(true);
+    setPiece(from, Piece());
+    setPiece(to, piece);
 
-        Piece capturedPiece = getPiece(to);
-        if(!capturedPiece.isEmpty()) {
-            addCapturedPiece(capturedPiece);
+    // Only remember the en passant square when an enemy pawn can actually use it
+    if(piece.getType() == PAWN && abs(to.row - from.row) == 2) {
+        Color enemy = oppositeColor(piece.getColor());
+        for(int colOffset = -1; colOffset <= 1; colOffset += 2) {
+            Piece neighbour = getPiece(to.row, to.col + colOffset);
+            if(neighbour.getType() == PAWN && neighbour.getColor() == enemy) {
+                setEnPassantSquare(squareIndex((from.row + to.row) / 2, from.col));
+            }
         }
+    }
+    return true;
+}
 
-        Piece promotedPiece(move.getPromotionPiece(), piece.getColor());
-        promotedPiece.setHasMoved(true);
+void Board::unmakeMove(PackedMove move, const MoveUndo& undo) {
+    Position from = move.getFrom();
+    Position to = move.getTo();
+    Piece piece = getPiece(to);
 
-        setPiece(to, promotedPiece);
-        setPiece(from, Piece());
-        return true;
+    if(move.isCastlingMove()) {
+        int rookFromCol = (to.col > from.col) ? 7 : 0;
+        int rookToCol = (to.col > from.col) ? 5 : 3;
+        Piece rook = getPiece(from.row, rookToCol);
+        if(!rook.isEmpty()) {
+            rook.setHasMoved(undo.rookHadMoved);
+            setPiece(from.row, rookToCol, Piece());
+            setPiece(from.row, rookFromCol, rook);
+        }
+    }
+
+    if(move.isPromotionMove()) {
+        piece = Piece(PAWN, piece.getColor());
     }
-    return movePiece(from, to);
+    piece.setHasMoved(undo.movedHadMoved);
+    setPiece(to, Piece());
+    setPiece(from, piece);
+    setPiece(undo.capturedPos, undo.captured);
+
+    setEnPassantSquare(undo.enPassantSquare);
+    setSideToMove(undo.sideToMove);
+}
+
+// Passes the turn without moving, for null-move pruning
+void Board::makeNullMove(MoveUndo& undo) {
+    undo.enPassantSquare = enPassantSquare;
+    undo.sideToMove = sideToMove;
+    setEnPassantSquare(-1);
+    setSideToMove(oppositeColor(sideToMove));
+}
+
+void Board::unmakeNullMove(const MoveUndo& undo) {
+    setEnPassantSquare(undo.enPassantSquare);
+    setSideToMove(undo.sideToMove);
+}
+
+int Board::getEnPassantSquare() const {
+    return enPassantSquare;
+}
+
+Color Board::getSideToMove() const {
+    return sideToMove;
+}
+
+void Board::setSideToMove(Color color) {
+    if(color != sideToMove) {
+        zobristKey ^= Zobrist::sideKey();
+        sideToMove = color;
+    }
+}
+
+int Board::getCastlingRights() const {
+    return castlingRights;
+}
+
+uint64_t Board::getZobristKey() const {
+    return zobristKey;
+}
+
+// Full recomputation, used to check the incrementally updated key
+uint64_t Board::computeZobristKey() const {
+    uint64_t key = 0;
+    for(int color = WHITE; color <= BLACK; color++) {
+        for(int type = PAWN; type <= KING; type++) {
+            Bitboard pieces = pieceBB[color][type];
+            while(pieces) {
+                key ^= Zobrist::pieceKey(static_cast<PieceType>(type), static_cast<Color>(color), popLsb(pieces));
+            }
+        }
+    }
+    key ^= Zobrist::castlingKey(castlingRights);
+    key ^= Zobrist::enPassantKey(enPassantSquare);
+    if(sideToMove == WHITE) {
+        key ^= Zobrist::sideKey();
+    }
+    return key;
 }
 
 void Board::addCapturedPiece(Piece piece) {
@@ -173,39 +386,35 @@ void Board::addCapturedPiece(Piece piece) {
 }
 
 Position Board::findKing(Color color) const {
-    for(int row = 0; row < 8; row++) {
-        for(int col = 0; col < 8; col++) {
-            Piece piece = board[row][col];
-            if(piece.getType() == KING && piece.getColor() == color) {
-                return Position(row, col);
-            }
-        }
+    int square = getKingSquare(color);
+    if(square < 0) {
+        return Position(-1, -1);
+    }
+    return squareToPosition(square);
+}
+
+int Board::getKingSquare(Color color) const {
+    if(color != WHITE && color != BLACK) {
+        return -1;
     }
-    return Position(-1, -1);
+    return kingSquare[color];
 }
 
 vector<Position> Board::findAllPieces(Color color) const {
     vector<Position> pieces;
-    for(int row = 0; row < 8; row++) {
-        for(int col = 0; col < 8; col++) {
-            Piece piece = board[row][col];
-            if(!piece.isEmpty() && piece.getColor() == color) {
-                pieces.push_back(Position(row, col));
-            }
-        }
+    Bitboard remaining = getPieces(color);
+    pieces.reserve(popCount(remaining));
+    while(remaining) {
+        pieces.push_back(squareToPosition(popLsb(remaining)));
     }
     return pieces;
 }
 
 vector<Position> Board::findPieceTypes(PieceType type, Color color) const {
     vector<Position> pieces;
-    for(int row = 0; row < 8; row++) {
-        for(int col = 0; col < 8; col++) {
-            Piece piece = board[row][col];
-            if(piece.getType() == type && piece.getColor() == color) {
-                pieces.push_back(Position(row, col));
-            }
-        }
+    Bitboard remaining = getPieces(type, color);
+    while(remaining) {
+        pieces.push_back(squareToPosition(popLsb(remaining)));
     }
     return pieces;
 }
@@ -263,6 +472,24 @@ Board Board::copy() const {
             newBoard.board[row][col] = board[row][col];
         }
     }
+    for(int color = 0; color < 3; color++) {
+        for(int type = 0; type < 7; type++) {
+            newBoard.pieceBB[color][type] = pieceBB[color][type];
+            newBoard.pieceCount[color][type] = pieceCount[color][type];
+        }
+        newBoard.colorBB[color] = colorBB[color];
+        newBoard.colorCount[color] = colorCount[color];
+        newBoard.kingSquare[color] = kingSquare[color];
+    }
+    newBoard.occupiedBB = occupiedBB;
+    newBoard.materialScore = materialScore;
+    newBoard.middlegameScore = middlegameScore;
+    newBoard.endgameScore = endgameScore;
+    newBoard.phase = phase;
+    newBoard.enPassantSquare = enPassantSquare;
+    newBoard.sideToMove = sideToMove;
+    newBoard.castlingRights = castlingRights;
+    newBoard.zobristKey = zobristKey;
 
     newBoard.whiteCaptured = whiteCaptured;
     newBoard.blackCaptured = blackCaptured;
@@ -270,29 +497,51 @@ Board Board::copy() const {
 }
 
 int Board::countPieces(Color color) const {
-    int count = 0;
-    for(int row = 0; row < 8; row++) {
-        for(int col = 0; col < 8; col++) {
-            Piece piece = board[row][col];
-            if(!board[row][col].isEmpty() && board[row][col].getColor() == color) {
-                count++;
-            }
-        }
+    if(color != WHITE && color != BLACK) {
+        return 0;
     }
-    return count;
+    return colorCount[color];
 }
 
 int Board::countPieceType(PieceType type, Color color) const {
-    int count = 0;
-    for(int row = 0; row < 8; row++) {
-        for(int col = 0; col < 8; col++) {
-            Piece piece = board[row][col];
-            if(piece.getType() == type && piece.getColor() == color) {
-                count++;
-            }
-        }
+    if(type < PAWN || type > KING || (color != WHITE && color != BLACK)) {
+        return 0;
     }
-    return count;
+    return pieceCount[color][type];
+}
+
+int Board::getMaterialScore() const {
+    return materialScore;
+}
+
+int Board::getMiddlegameScore() const {
+    return middlegameScore;
+}
+
+int Board::getEndgameScore() const {
+    return endgameScore;
+}
+
+int Board::getPhase() const {
+    return phase;
+}
+
+Bitboard Board::getPieces(PieceType type, Color color) const {
+    if(type < PAWN || type > KING || (color != WHITE && color != BLACK)) {
+        return EMPTY_BB;
+    }
+    return pieceBB[color][type];
+}
+
+Bitboard Board::getPieces(Color color) const {
+    if(color != WHITE && color != BLACK) {
+        return EMPTY_BB;
+    }
+    return colorBB[color];
+}
+
+Bitboard Board::getOccupied() const {
+    return occupiedBB;
 }
 
 string Board::toString() const {
@@ -3,15 +3,56 @@
 
 #include "Piece.h"
 #include "Move.h"
+#include "PackedMove.h"
 #include "../utils/Types.h"
+#include "../utils/Bitboard.h"
 #include <vector>
 #include <string>
 
+// Everything makeMove changes that unmakeMove cannot recompute from the move itself
+struct MoveUndo {
+    Piece captured;
+    Position capturedPos;
+    bool movedHadMoved;
+    bool rookHadMoved;
+    int enPassantSquare;
+    Color sideToMove;
+};
+
 class Board {
     private:
         Piece board[8][8];
         vector<Piece> whiteCaptured;
         vector<Piece> blackCaptured;
+
+        // Bitboard view of the same position, kept in sync by setPiece
+        Bitboard pieceBB[3][7];
+        Bitboard colorBB[3];
+        Bitboard occupiedBB;
+
+        // Piece counts and king squares (-1 if missing), also kept in sync by setPiece
+        int pieceCount[3][7];
+        int colorCount[3];
+        int kingSquare[3];
+
+        // Material and middlegame/endgame piece-square totals, white minus
+        // black, and the game phase of the pieces on the board. Also kept in
+        // sync by setPiece so the evaluator reads them without a board scan.
+        int materialScore;
+        int middlegameScore;
+        int endgameScore;
+        int phase;
+
+        // Square a pawn may capture onto en passant, -1 if none
+        int enPassantSquare;
+        Color sideToMove;
+        int castlingRights;
+
+        // Zobrist hash of placement, side to move, castling rights and en passant file
+        uint64_t zobristKey;
+
+        void clearBitboards();
+        void updateCastlingRights();
     public:
         Board();
 
@@ -32,9 +73,24 @@ class Board {
 
         bool movePiece(Position from, Position to);
         bool executeMove(const Move& move);
+        bool makeMove(const Move& move, MoveUndo& undo);
+        void unmakeMove(const Move& move, const MoveUndo& undo);
+        bool makeMove(PackedMove move, MoveUndo& undo);
+        void unmakeMove(PackedMove move, const MoveUndo& undo);
+        void makeNullMove(MoveUndo& undo);
+        void unmakeNullMove(const MoveUndo& undo);
+        int getEnPassantSquare() const;
+        void setEnPassantSquare(int square);
+
+        Color getSideToMove() const;
+        void setSideToMove(Color color);
+        int getCastlingRights() const;
+        uint64_t getZobristKey() const;
+        uint64_t computeZobristKey() const;
         void addCapturedPiece(Piece piece);
 
         Position findKing(Color color) const;
+        int getKingSquare(Color color) const;
         vector<Position> findAllPieces(Color color) const;
         vector<Position> findPieceTypes(PieceType type, Color color) const;
 
@@ -49,6 +105,15 @@ class Board {
 
         int countPieces(Color color) const;
         int countPieceType(PieceType type, Color color) const;
+        int getMaterialScore() const;
+        int getMiddlegameScore() const;
+        int getEndgameScore() const;
+        // Phase weight of the pieces left, PieceSquareTables::MAX_PHASE or more in the opening
+        int getPhase() const;
+
+        Bitboard getPieces(PieceType type, Color color) const;
+        Bitboard getPieces(Color color) const;
+        Bitboard getOccupied() const;
 
         string toString() const;
 };
@@ -1,5 +1,7 @@
 #include "ChessAPI.h"
 #include "GameRules.h"
+#include "Perft.h"
+#include "../engine/EndgameBitbases.h"
 #include "../utils/Types.h"
 #include <sstream>
 #include <fstream>
@@ -9,10 +11,16 @@ using namespace std;
 
 // Session file to persist game state
 const string ChessAPI::SESSION_FILE = "chess_session.bin";
+const string ChessAPI::BOOK_FILE = "opening_book.bin";
+const string ChessAPI::BITBASE_FILE = "endgame_bitbases.bin";
 
 // Constructor - Load existing game or start new
 ChessAPI::ChessAPI() {
     aiEnabled = false;
+    ponderEnabled = false;
+    
+    // Mapped once for the whole process, every AI shares them
+    EndgameBitbases::load(BITBASE_FILE);
     
     // Try to load existing session
     ifstream file(SESSION_FILE, ios::binary);
@@ -54,15 +62,23 @@ void ChessAPI::saveState() {
     file.write(reinterpret_cast<const char*>(&aiEnabled), sizeof(bool));
     
     // NEW: Save AI difficulty level
-    int aiDifficulty = 1; // 0=none, 1=easy, 2=medium, 3=hard
-    if (!aiEnabled) {
-        aiDifficulty = 0;
-    } else if (ai) {
-        // Try to determine difficulty (we'll use medium as default)
-        aiDifficulty = 2; // Assume medium
+    int aiDifficulty = 0; // 0=none, 1=easy, 2=medium, 3=hard
+    int aiTimeMs = 0;
+    int aiNodes = 0;
+    int aiThreads = 1;
+    if (aiEnabled && ai) {
+        aiDifficulty = static_cast<int>(ai->getDifficulty()) + 1;
+        aiTimeMs = ai->getTimeLimitMs();
+        aiNodes = ai->getNodeLimit();
+        aiThreads = ai->getThreads();
     }
     file.write(reinterpret_cast<const char*>(&aiDifficulty), sizeof(int));
     
+    // Save AI search budget (appended, older session files simply end before it)
+    file.write(reinterpret_cast<const char*>(&aiTimeMs), sizeof(int));
+    file.write(reinterpret_cast<const char*>(&aiNodes), sizeof(int));
+    file.write(reinterpret_cast<const char*>(&aiThreads), sizeof(int));
+    
     file.close();
 }
 
@@ -107,6 +123,23 @@ void ChessAPI::loadState() {
     int aiDifficulty = 2; // default to medium
     file.read(reinterpret_cast<char*>(&aiDifficulty), sizeof(int));
     
+    // Load AI search budget (if available)
+    int aiTimeMs = 0;
+    int aiNodes = 0;
+    if (file.read(reinterpret_cast<char*>(&aiTimeMs), sizeof(int))) {
+        file.read(reinterpret_cast<char*>(&aiNodes), sizeof(int));
+    }
+    if (!file) {
+        aiTimeMs = 0;
+        aiNodes = 0;
+    }
+    
+    // Load AI thread count (if available)
+    int aiThreads = 1;
+    if (!file.read(reinterpret_cast<char*>(&aiThreads), sizeof(int))) {
+        aiThreads = 1;
+    }
+    
     file.close();
     
     // CRITICAL: DON'T restore AI if it was just set by setAI()
@@ -123,6 +156,9 @@ void ChessAPI::loadState() {
                 case 3: ai = make_unique<AI>(HARD); break;
                 default: ai = make_unique<AI>(MEDIUM);
             }
+            ai->setSearchLimits(aiTimeMs, aiNodes);
+            ai->setThreads(aiThreads);
+            ai->loadOpeningBook(BOOK_FILE);
         }
     }
     // If AI was just set, keep the current AI object
@@ -151,13 +187,16 @@ void ChessAPI::loadState() {
 
 // Start new game
 void ChessAPI::newGame() {
+    if (ai) {
+        ai->stopPondering();
+    }
     game.reset();
     game.startNewGame();
     saveState();
 }
 
 // Set AI difficulty
-void ChessAPI::setAI(const string& difficulty) {
+void ChessAPI::setAI(const string& difficulty, int timeMs, int nodes, int threads) {
     if (difficulty == "easy") {
         aiEnabled = true;
         ai = make_unique<AI>(EASY);
@@ -171,9 +210,21 @@ void ChessAPI::setAI(const string& difficulty) {
         aiEnabled = false;
         ai.reset();
     }
+    if (ai) {
+        ai->setSearchLimits(timeMs, nodes);
+        ai->setThreads(threads);
+        ai->loadOpeningBook(BOOK_FILE);
+    }
     saveState();
 }
 
+void ChessAPI::setPondering(bool enabled) {
+    ponderEnabled = enabled;
+    if (!enabled && ai) {
+        ai->stopPondering();
+    }
+}
+
 // Make a move
 bool ChessAPI::makeMove(const string& from, const string& to) {
     Position fromPos = Position::fromString(from);
@@ -185,6 +236,9 @@ bool ChessAPI::makeMove(const string& from, const string& to) {
     
     bool success = game.makeMove(fromPos, toPos);
     if (success) {
+        if (ai) {
+            ai->resolvePonder(game);
+        }
         saveState();
     }
     return success;
@@ -196,7 +250,8 @@ string ChessAPI::getAIMove() {
         return "{\"error\":\"AI not enabled\"}";
     }
     
-    Move aiMove = ai->getBestMove(game, game.getCurrentPlayer(), true);
+    Color aiColor = game.getCurrentPlayer();
+    Move aiMove = ai->getBestMove(game, aiColor, true);
     
     if (!aiMove.isValid()) {
         return "{\"error\":\"No valid move\"}";
@@ -205,10 +260,26 @@ string ChessAPI::getAIMove() {
     game.makeMove(aiMove);
     saveState();
     
+    if (ponderEnabled && !game.isGameOver()) {
+        ai->startPondering(game, aiColor);
+    }
+    
     stringstream ss;
     ss << "{";
     ss << "\"from\":\"" << aiMove.getFrom().toString() << "\",";
-    ss << "\"to\":\"" << aiMove.getTo().toString() << "\"";
+    ss << "\"to\":\"" << aiMove.getTo().toString() << "\",";
+    ss << "\"pv\":[";
+    const vector<Move>& pv = ai->getPrincipalVariation();
+    for (size_t i = 0; i < pv.size(); i++) {
+        if (i > 0) ss << ",";
+        ss << "\"" << pv[i].getFrom().toString() << pv[i].getTo().toString() << "\"";
+    }
+    ss << "],";
+    ss << "\"book\":" << (ai->isBookMove() ? "true" : "false");
+    if (ai->isPondering()) {
+        Move ponderMove = ai->getPonderMove();
+        ss << ",\"ponder\":\"" << ponderMove.getFrom().toString() << ponderMove.getTo().toString() << "\"";
+    }
     ss << "}";
     
     return ss.str();
@@ -220,6 +291,10 @@ bool ChessAPI::undoMove() {
         return false;
     }
     
+    if (ai) {
+        ai->stopPondering();
+    }
+    
     bool success = game.undoMove();
     
     // In AI mode, undo both moves (player + AI)
@@ -309,6 +384,39 @@ string ChessAPI::getValidMovesJSON(const string& position) {
     return ss.str();
 }
 
+// Run perft with divide output on a FEN (or the current game when empty)
+string ChessAPI::getPerftJSON(int depth, int threads, const string& fen) {
+    Game perftGame;
+    const Game* source = &game;
+    
+    if (!fen.empty()) {
+        if (!perftGame.loadFEN(fen)) {
+            return "{\"error\":\"Invalid FEN\"}";
+        }
+        source = &perftGame;
+    }
+    
+    Perft::Result result = Perft::divide(source->getBoard(), source->getCurrentPlayer(), depth, threads);
+    
+    stringstream ss;
+    ss << "{";
+    ss << "\"fen\":\"" << source->toFEN() << "\",";
+    ss << "\"depth\":" << result.depth << ",";
+    ss << "\"threads\":" << result.threads << ",";
+    ss << "\"divide\":[";
+    for (size_t i = 0; i < result.divide.size(); i++) {
+        if (i > 0) ss << ",";
+        ss << "{\"move\":\"" << result.divide[i].move.toUCI() << "\",";
+        ss << "\"nodes\":" << result.divide[i].nodes << "}";
+    }
+    ss << "],";
+    ss << "\"nodes\":" << result.nodes << ",";
+    ss << "\"timeMs\":" << static_cast<long long>(result.seconds * 1000.0) << ",";
+    ss << "\"nps\":" << result.nodesPerSecond();
+    ss << "}";
+    return ss.str();
+}
+
 // Check if game is over
 bool ChessAPI::isGameOver() const {
     return game.isGameOver();
@@ -317,4 +425,42 @@ bool ChessAPI::isGameOver() const {
 // Get current player
 string ChessAPI::getCurrentPlayer() const {
     return colorToString(game.getCurrentPlayer());
-}
\ No newline at end of file
+}
+
+string ChessAPI::buildBookJSON(const string& pgnPath, const string& bookPath, int maxPly) {
+    OpeningBook::BuildResult result = OpeningBook::build(pgnPath, bookPath, maxPly);
+    
+    stringstream ss;
+    ss << "{";
+    ss << "\"success\":" << (result.success ? "true" : "false") << ",";
+    ss << "\"games\":" << result.games << ",";
+    ss << "\"skipped\":" << result.skippedGames << ",";
+    ss << "\"positions\":" << result.positions << ",";
+    ss << "\"entries\":" << result.entries;
+    ss << "}";
+    
+    return ss.str();
+}
+
+string ChessAPI::buildBitbasesJSON(const string& path, int threads) {
+    // The tables are remapped below, so no search may be reading them
+    if (ai) {
+        ai->stopPondering();
+    }
+    
+    string file = path.empty() ? BITBASE_FILE : path;
+    EndgameBitbases::GenerateResult result = EndgameBitbases::generate(file, threads);
+    bool loaded = result.success && EndgameBitbases::load(file);
+    
+    stringstream ss;
+    ss << "{";
+    ss << "\"success\":" << (result.success ? "true" : "false") << ",";
+    ss << "\"loaded\":" << (loaded ? "true" : "false") << ",";
+    ss << "\"kpkWins\":" << result.wins[0] << ",";
+    ss << "\"krkWins\":" << result.wins[1] << ",";
+    ss << "\"kqkWins\":" << result.wins[2] << ",";
+    ss << "\"iterations\":" << result.iterations;
+    ss << "}";
+    
+    return ss.str();
+}
@@ -13,9 +13,14 @@ class ChessAPI {
         Game game;
         unique_ptr<AI> ai;
         bool aiEnabled;
+        bool ponderEnabled;
         
         // Session file path
         static const string SESSION_FILE;
+        // Opening book the AI plays from, when present
+        static const string BOOK_FILE;
+        // KPK/KRK/KQK bitbases the AI and evaluator probe, when present
+        static const string BITBASE_FILE;
         
         // Save/Load game state
         void saveState();
@@ -24,7 +29,11 @@ class ChessAPI {
     public:
         ChessAPI();
         void newGame();
-        void setAI(const string& difficulty);
+        // timeMs and nodes bound each AI move, 0 keeps the difficulty default
+        void setAI(const string& difficulty, int timeMs = 0, int nodes = 0, int threads = 1);
+        // Lets the AI search on the opponent's time after each move. Only
+        // useful when the process stays alive between commands.
+        void setPondering(bool enabled);
 
         bool makeMove(const string& from, const string& to);
         string getAIMove();
@@ -33,6 +42,11 @@ class ChessAPI {
         string getBoardJSON();
         string getGameStatusJSON();
         string getValidMovesJSON(const string& position);
+        string getPerftJSON(int depth, int threads, const string& fen);
+        // Builds an opening book at bookPath from a PGN collection
+        string buildBookJSON(const string& pgnPath, const string& bookPath, int maxPly);
+        // Generates the endgame bitbases at path (BITBASE_FILE if empty) and loads them
+        string buildBitbasesJSON(const string& path, int threads);
 
         bool isGameOver() const;
         string getCurrentPlayer() const;
@@ -2,6 +2,7 @@
 #include <iostream>
 #include <cmath>
 #include <cstdlib>
+#include <sstream>
 
 using namespace std;
 
@@ -45,7 +46,8 @@ bool Game::makeMove(Position from, Position to) {
 
 bool Game::makeMove(Move move) {
     if (gameOver) {
-        cout << "Game is over! Start a new game.\n";
+        // stderr, so chess_cli's stdout stays one JSON reply per command
+        cerr << "Game is over! Start a new game.\n";
         return false;
     }
     
@@ -92,7 +94,7 @@ bool Game::makeMove(Move move) {
 bool Game::undoMove() {
     // STACK OPERATION: Pop previous board state
     if (boardHistory.empty()) {
-        cout << "Cannot undo - no moves made yet.\n";
+        cerr << "Cannot undo - no moves made yet.\n";
         return false;
     }
     
@@ -170,6 +172,7 @@ string Game::getGameStatus() const {
 
 void Game::setCurrentPlayer(Color player) {
     currentPlayer = player;
+    board.setSideToMove(player);
 }
 
 // ============================================================================
@@ -193,18 +196,16 @@ bool Game::isValidMove(Position from, Position to) const {
         return false;
     }
     
-    // Check if move follows piece rules
-    if (!GameRules::isBasicMoveLegal(board, from, to, lastMove)) {
-        return false;
-    }
-    
-    // Check if move would leave king in check (BACKTRACKING)
-    Move testMove(from, to, piece.getType(), board.getPiece(to).getType());
-    if (GameRules::wouldBeInCheck(board, testMove, currentPlayer)) {
-        return false;
+    // The move must be one of the legal moves generated for this piece
+    MoveList legalMoves;
+    GameRules::getValidMovesForPiece(board, from, legalMoves);
+    for (PackedMove move : legalMoves) {
+        if (move.getTo() == to) {
+            return true;
+        }
     }
     
-    return true;
+    return false;
 }
 
 bool Game::isValidMove(Move move) const {
@@ -220,13 +221,24 @@ vector<Move> Game::getValidMoves(Position pos) const {
     }
     
     // Get valid moves from GameRules
-    Board tempBoard = board.copy();
-    return GameRules::getValidMovesForPiece(tempBoard, pos, lastMove);
+    MoveList moves;
+    GameRules::getValidMovesForPiece(board, pos, moves);
+    return toMoves(moves);
 }
 
 vector<Move> Game::getAllValidMovesForCurrentPlayer() const {
-    Board tempBoard = board.copy();
-    return GameRules::getAllValidMoves(tempBoard, currentPlayer, lastMove);
+    MoveList moves;
+    GameRules::getAllValidMoves(board, currentPlayer, moves);
+    return toMoves(moves);
+}
+
+vector<Move> Game::toMoves(const MoveList& moves) const {
+    vector<Move> result;
+    result.reserve(moves.size());
+    for (PackedMove move : moves) {
+        result.push_back(move.toMove(board));
+    }
+    return result;
 }
 
 // ============================================================================
@@ -242,23 +254,19 @@ bool Game::isInCheck(Color color) const {
 }
 
 bool Game::isCheckmate() const {
-    Board tempBoard = board.copy();
-    return GameRules::isCheckmate(tempBoard, currentPlayer);
+    return GameRules::isCheckmate(board, currentPlayer);
 }
 
 bool Game::isCheckmate(Color color) const {
-    Board tempBoard = board.copy();
-    return GameRules::isCheckmate(tempBoard, color);
+    return GameRules::isCheckmate(board, color);
 }
 
 bool Game::isStalemate() const {
-    Board tempBoard = board.copy();
-    return GameRules::isStalemate(tempBoard, currentPlayer);
+    return GameRules::isStalemate(board, currentPlayer);
 }
 
 bool Game::isStalemate(Color color) const {
-    Board tempBoard = board.copy();
-    return GameRules::isStalemate(tempBoard, color);
+    return GameRules::isStalemate(board, color);
 }
 
 // ============================================================================
@@ -328,9 +336,170 @@ void Game::reset() {
 }
 
 string Game::toFEN() const {
-    // Simplified FEN notation (optional advanced feature)
-    // You can implement full FEN later if needed
-    return "FEN notation not implemented yet";
+    string fen = "";
+
+    for (int row = 7; row >= 0; row--) {
+        int emptyCount = 0;
+        for (int col = 0; col < 8; col++) {
+            Piece piece = board.getPiece(row, col);
+            if (piece.isEmpty()) {
+                emptyCount++;
+                continue;
+            }
+            if (emptyCount > 0) {
+                fen += to_string(emptyCount);
+                emptyCount = 0;
+            }
+            fen += piece.getSymbol();
+        }
+        if (emptyCount > 0) {
+            fen += to_string(emptyCount);
+        }
+        if (row > 0) {
+            fen += "/";
+        }
+    }
+
+    fen += (currentPlayer == WHITE) ? " w " : " b ";
+
+    // Castling rights follow the hasMoved flags of kings and rooks on their home squares
+    string castling = "";
+    const int homeRows[2] = {0, 7};
+    const Color colors[2] = {WHITE, BLACK};
+    for (int i = 0; i < 2; i++) {
+        Piece king = board.getPiece(homeRows[i], 4);
+        if (king.getType() != KING || king.getColor() != colors[i] || king.getHasMoved()) {
+            continue;
+        }
+        Piece kingsideRook = board.getPiece(homeRows[i], 7);
+        Piece queensideRook = board.getPiece(homeRows[i], 0);
+        string rights = "";
+        if (kingsideRook.getType() == ROOK && kingsideRook.getColor() == colors[i] && !kingsideRook.getHasMoved()) {
+            rights += "K";
+        }
+        if (queensideRook.getType() == ROOK && queensideRook.getColor() == colors[i] && !queensideRook.getHasMoved()) {
+            rights += "Q";
+        }
+        if (colors[i] == BLACK) {
+            for (char& c : rights) {
+                c = tolower(c);
+            }
+        }
+        castling += rights;
+    }
+    fen += castling.empty() ? "-" : castling;
+
+    // En passant target square comes from a double pawn push on the last move
+    Position from = lastMove.getFrom();
+    Position to = lastMove.getTo();
+    if (lastMove.isValid() && lastMove.getMovedPiece() == PAWN && abs(to.row - from.row) == 2) {
+        fen += " " + Position((from.row + to.row) / 2, from.col).toString();
+    } else {
+        fen += " -";
+    }
+
+    fen += " 0 " + to_string(moveCount / 2 + 1);
+    return fen;
+}
+
+bool Game::loadFEN(const string& fen) {
+    stringstream ss(fen);
+    string placement, side, castling, enPassant;
+    int halfmoveClock = 0;
+    int fullmoveNumber = 1;
+
+    ss >> placement >> side;
+    if (placement.empty() || side.empty()) {
+        return false;
+    }
+    if (!(ss >> castling)) castling = "-";
+    if (!(ss >> enPassant)) enPassant = "-";
+    if (!(ss >> halfmoveClock)) halfmoveClock = 0;
+    if (!(ss >> fullmoveNumber)) fullmoveNumber = 1;
+
+    Board loaded;
+    int row = 7;
+    int col = 0;
+    for (char c : placement) {
+        if (c == '/') {
+            row--;
+            col = 0;
+            continue;
+        }
+        if (c >= '1' && c <= '8') {
+            col += c - '0';
+            continue;
+        }
+
+        PieceType type;
+        switch (tolower(c)) {
+            case 'p': type = PAWN; break;
+            case 'n': type = KNIGHT; break;
+            case 'b': type = BISHOP; break;
+            case 'r': type = ROOK; break;
+            case 'q': type = QUEEN; break;
+            case 'k': type = KING; break;
+            default: return false;
+        }
+        if (!loaded.isPositionValid(row, col)) {
+            return false;
+        }
+
+        Piece piece(type, isupper(c) ? WHITE : BLACK);
+        // Kings and rooks count as moved unless a castling right says otherwise
+        if (type == KING || type == ROOK) {
+            piece.setHasMoved(true);
+        }
+        loaded.setPiece(row, col, piece);
+        col++;
+    }
+    if (row != 0 || !loaded.findKing(WHITE).isValid() || !loaded.findKing(BLACK).isValid()) {
+        return false;
+    }
+
+    for (char c : castling) {
+        int homeRow = isupper(c) ? 0 : 7;
+        int rookCol;
+        if (tolower(c) == 'k') rookCol = 7;
+        else if (tolower(c) == 'q') rookCol = 0;
+        else continue;
+
+        Piece king = loaded.getPiece(homeRow, 4);
+        Piece rook = loaded.getPiece(homeRow, rookCol);
+        if (king.getType() == KING && rook.getType() == ROOK) {
+            king.setHasMoved(false);
+            rook.setHasMoved(false);
+            loaded.setPiece(homeRow, 4, king);
+            loaded.setPiece(homeRow, rookCol, rook);
+        }
+    }
+
+    startNewGame();
+    board = loaded;
+    setCurrentPlayer((side == "b") ? BLACK : WHITE);
+
+    // Rebuild the double pawn push that created the en passant square
+    Position epSquare = Position::fromString(enPassant);
+    if (epSquare.isValid() && (epSquare.row == 2 || epSquare.row == 5)) {
+        int direction = (epSquare.row == 2) ? 1 : -1;
+        Position pushedTo(epSquare.row + direction, epSquare.col);
+        lastMove = Move(Position(epSquare.row - direction, epSquare.col), pushedTo, PAWN, EMPTY);
+
+        for (int colOffset = -1; colOffset <= 1; colOffset += 2) {
+            Piece neighbour = board.getPiece(pushedTo.row, pushedTo.col + colOffset);
+            if (neighbour.getType() == PAWN && neighbour.getColor() == currentPlayer) {
+                board.setEnPassantSquare(squareIndex(epSquare));
+            }
+        }
+    }
+
+    moveCount = (fullmoveNumber - 1) * 2 + (currentPlayer == BLACK ? 1 : 0);
+    if (moveCount < 0) {
+        moveCount = 0;
+    }
+
+    checkGameEnd();
+    return true;
 }
 
 // ============================================================================
@@ -74,12 +74,14 @@ class Game {
     void reset();
 
     string toFEN() const;
+    bool loadFEN(const string& fen);
 
     private:
     void switchPlayer();
     void checkGameEnd();
     bool handleSpecialMoves(Move& move);
     void saveCurrentBoardState();
+    vector<Move> toMoves(const MoveList& moves) const;
 
 
 };
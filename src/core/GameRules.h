@@ -3,8 +3,8 @@
 
 #include "Board.h"
 #include "Move.h"
+#include "MoveList.h"
 #include "../utils/Types.h"
-#include <vector>
 
 class GameRules {
 public:
@@ -19,23 +19,14 @@ public:
     static bool canEnPassant(const Board& board, Position from, Position to, const Move& lastMove);
     static bool canPromote(const Board& board, Position pos);
     static bool isKingInCheck(const Board& board, Color kingColor);
-    static bool wouldBeInCheck(Board board, Move move, Color kingColor);
     static bool isSquareAttacked(const Board& board, Position pos, Color attackerColor);
-    static bool isCheckmate(Board& board, Color color);
-    static bool isStalemate(Board& board, Color color);
+    static Bitboard getAttackers(const Board& board, Position pos, Color attackerColor);
+    static bool isCheckmate(const Board& board, Color color);
+    static bool isStalemate(const Board& board, Color color);
     static bool isDrawByInsufficientMaterial(const Board& board);
-    static std::vector<Move> getValidMovesForPiece(Board& board, Position pos, const Move& lastMove);
-    static std::vector<Move> getAllValidMoves(Board& board, Color color, const Move& lastMove);
-    static bool isBasicMoveLegal(const Board& board, Position from, Position to, const Move& lastMove);
-    static std::vector<Move> getPossibleMovesForPiece(const Board& board, Position pos, const Move& lastMove);
-
-private:
-    static std::vector<Move> generatePawnMoves(const Board& board, Position pos, const Move& lastMove);
-    static std::vector<Move> generateKnightMoves(const Board& board, Position pos);
-    static std::vector<Move> generateBishopMoves(const Board& board, Position pos);
-    static std::vector<Move> generateRookMoves(const Board& board, Position pos);
-    static std::vector<Move> generateQueenMoves(const Board& board, Position pos);
-    static std::vector<Move> generateKingMoves(const Board& board, Position pos);
+    // Generators append to the caller's list; en passant comes from the board's own state
+    static void getValidMovesForPiece(const Board& board, Position pos, MoveList& moves);
+    static void getAllValidMoves(const Board& board, Color color, MoveList& moves);
 };
 
 #endif // GAMERULES_H
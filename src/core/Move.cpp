@@ -163,6 +163,22 @@ string Move::toString() const {
     
     return result;
 }
+string Move::toUCI() const {
+    string result = from.toString() + to.toString();
+
+    if (isPromotionMove()) {
+        switch (promotionPiece) {
+            case KNIGHT: result += "n"; break;
+            case BISHOP: result += "b"; break;
+            case ROOK:   result += "r"; break;
+            case QUEEN:  result += "q"; break;
+            default: break;
+        }
+    }
+
+    return result;
+}
+
 bool Move::isValid() const {
     return from.isValid() && to.isValid() && movedPiece != EMPTY;
 }
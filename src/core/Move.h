@@ -46,6 +46,7 @@ class Move
 
         string toString() const;
         string toAlgebraicNotation() const;
+        string toUCI() const;
         bool isValid() const;
 
 };
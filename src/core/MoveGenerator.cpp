@@ -0,0 +1,269 @@
+#include "MoveGenerator.h"
+#include "Attacks.h"
+#include "Zobrist.h"
+
+using namespace std;
+
+// ============================================================================
+// ATTACK QUERIES
+// ============================================================================
+
+Bitboard MoveGenerator::attackersTo(const Board &board, int square, Bitboard occupied)
+{
+    Bitboard bishopsQueens = board.getPieces(BISHOP, WHITE) | board.getPieces(BISHOP, BLACK) |
+                             board.getPieces(QUEEN, WHITE) | board.getPieces(QUEEN, BLACK);
+    Bitboard rooksQueens = board.getPieces(ROOK, WHITE) | board.getPieces(ROOK, BLACK) |
+                           board.getPieces(QUEEN, WHITE) | board.getPieces(QUEEN, BLACK);
+
+    return (Attacks::pawnAttacks(WHITE, square) & board.getPieces(PAWN, BLACK)) |
+           (Attacks::pawnAttacks(BLACK, square) & board.getPieces(PAWN, WHITE)) |
+           (Attacks::knightAttacks(square) & (board.getPieces(KNIGHT, WHITE) | board.getPieces(KNIGHT, BLACK))) |
+           (Attacks::kingAttacks(square) & (board.getPieces(KING, WHITE) | board.getPieces(KING, BLACK))) |
+           (Attacks::bishopAttacks(square, occupied) & bishopsQueens) |
+           (Attacks::rookAttacks(square, occupied) & rooksQueens);
+}
+
+Bitboard MoveGenerator::attackedSquares(const Board &board, Color color, Bitboard occupied)
+{
+    Bitboard attacked = EMPTY_BB;
+
+    Bitboard pawns = board.getPieces(PAWN, color);
+    if (color == WHITE)
+        attacked |= ((pawns & ~FILE_A_BB) << 7) | ((pawns & ~FILE_H_BB) << 9);
+    else
+        attacked |= ((pawns & ~FILE_A_BB) >> 9) | ((pawns & ~FILE_H_BB) >> 7);
+
+    Bitboard knights = board.getPieces(KNIGHT, color);
+    while (knights)
+        attacked |= Attacks::knightAttacks(popLsb(knights));
+
+    Bitboard diagonal = board.getPieces(BISHOP, color) | board.getPieces(QUEEN, color);
+    while (diagonal)
+        attacked |= Attacks::bishopAttacks(popLsb(diagonal), occupied);
+
+    Bitboard straight = board.getPieces(ROOK, color) | board.getPieces(QUEEN, color);
+    while (straight)
+        attacked |= Attacks::rookAttacks(popLsb(straight), occupied);
+
+    Bitboard kings = board.getPieces(KING, color);
+    while (kings)
+        attacked |= Attacks::kingAttacks(popLsb(kings));
+
+    return attacked;
+}
+
+Bitboard MoveGenerator::pinnedPieces(const Board &board, Color color, int kingSquare)
+{
+    Color enemy = oppositeColor(color);
+    Bitboard occupied = board.getOccupied();
+    Bitboard ours = board.getPieces(color);
+
+    Bitboard snipers =
+        (Attacks::rookAttacks(kingSquare, EMPTY_BB) & (board.getPieces(ROOK, enemy) | board.getPieces(QUEEN, enemy))) |
+        (Attacks::bishopAttacks(kingSquare, EMPTY_BB) & (board.getPieces(BISHOP, enemy) | board.getPieces(QUEEN, enemy)));
+
+    Bitboard pinned = EMPTY_BB;
+    while (snipers)
+    {
+        Bitboard blockers = Attacks::between(kingSquare, popLsb(snipers)) & occupied;
+        if (blockers && !(blockers & (blockers - 1)) && (blockers & ours))
+            pinned |= blockers;
+    }
+    return pinned;
+}
+
+// ============================================================================
+// LEGAL MOVE GENERATION
+// ============================================================================
+
+void MoveGenerator::generateLegalMoves(const Board &board, Color color, MoveList &moves, Bitboard fromMask)
+{
+    generateMoves(board, color, moves, fromMask, false);
+}
+
+void MoveGenerator::generateLegalCaptures(const Board &board, Color color, MoveList &moves)
+{
+    generateMoves(board, color, moves, ALL_SQUARES_BB, true);
+}
+
+void MoveGenerator::generateMoves(const Board &board, Color color, MoveList &moves, Bitboard fromMask,
+                                  bool capturesOnly)
+{
+    Color enemy = oppositeColor(color);
+    Bitboard ours = board.getPieces(color);
+    Bitboard theirs = board.getPieces(enemy);
+    Bitboard occupied = board.getOccupied();
+    Bitboard pieceTargets = capturesOnly ? theirs : ~ours;
+    int kingSquare = board.getKingSquare(color);
+    Bitboard checkMask = ALL_SQUARES_BB;
+    Bitboard pinned = EMPTY_BB;
+
+    if (kingSquare >= 0)
+    {
+        // The king itself must not shadow squares behind it from sliders
+        Bitboard danger = attackedSquares(board, enemy, occupied ^ squareBB(kingSquare));
+        Bitboard checkers = attackersTo(board, kingSquare, occupied) & board.getPieces(enemy);
+
+        if (fromMask & squareBB(kingSquare))
+        {
+            addMoves(kingSquare, Attacks::kingAttacks(kingSquare) & pieceTargets & ~danger, moves);
+            if (!checkers && !capturesOnly)
+                addCastling(board, color, kingSquare, danger, moves);
+        }
+
+        // Double check: only the king can move
+        if (checkers & (checkers - 1))
+            return;
+
+        if (checkers)
+            checkMask = Attacks::between(kingSquare, lsbIndex(checkers)) | checkers;
+
+        pinned = pinnedPieces(board, color, kingSquare);
+    }
+
+    const PieceType pieceTypes[4] = {KNIGHT, BISHOP, ROOK, QUEEN};
+    for (PieceType type : pieceTypes)
+    {
+        Bitboard pieces = board.getPieces(type, color) & fromMask;
+        while (pieces)
+        {
+            int from = popLsb(pieces);
+            Bitboard targets;
+            switch (type)
+            {
+            case KNIGHT:
+                targets = Attacks::knightAttacks(from);
+                break;
+            case BISHOP:
+                targets = Attacks::bishopAttacks(from, occupied);
+                break;
+            case ROOK:
+                targets = Attacks::rookAttacks(from, occupied);
+                break;
+            default:
+                targets = Attacks::queenAttacks(from, occupied);
+                break;
+            }
+
+            targets &= pieceTargets & checkMask;
+            if (pinned & squareBB(from))
+                targets &= Attacks::line(kingSquare, from);
+
+            addMoves(from, targets, moves);
+        }
+    }
+
+    Bitboard pawns = board.getPieces(PAWN, color) & fromMask;
+    int forward = (color == WHITE) ? 8 : -8;
+    Bitboard startRank = (color == WHITE) ? (RANK_1_BB << 8) : (RANK_8_BB >> 8);
+    Bitboard promotionRank = (color == WHITE) ? RANK_8_BB : RANK_1_BB;
+
+    Bitboard remaining = pawns;
+    while (remaining)
+    {
+        int from = popLsb(remaining);
+        Bitboard targets = EMPTY_BB;
+
+        // Only pushes that promote count as tactical moves
+        int push = from + forward;
+        if (push >= 0 && push < 64 && !(occupied & squareBB(push)) &&
+            (!capturesOnly || (promotionRank & squareBB(push))))
+        {
+            targets |= squareBB(push);
+
+            int doublePush = push + forward;
+            if (!capturesOnly && (startRank & squareBB(from)) && !(occupied & squareBB(doublePush)))
+                targets |= squareBB(doublePush);
+        }
+        targets |= Attacks::pawnAttacks(color, from) & theirs;
+
+        targets &= checkMask;
+        if (pinned & squareBB(from))
+            targets &= Attacks::line(kingSquare, from);
+
+        addPawnMoves(from, targets, color, moves);
+    }
+
+    if (board.getEnPassantSquare() >= 0)
+        addEnPassant(board, color, kingSquare, pawns, moves);
+}
+
+// ============================================================================
+// HELPER FUNCTIONS
+// ============================================================================
+
+void MoveGenerator::addMoves(int from, Bitboard targets, MoveList &moves)
+{
+    while (targets)
+        moves.add(PackedMove(from, popLsb(targets)));
+}
+
+void MoveGenerator::addPawnMoves(int from, Bitboard targets, Color color, MoveList &moves)
+{
+    Bitboard promotionRank = (color == WHITE) ? RANK_8_BB : RANK_1_BB;
+
+    Bitboard promotions = targets & promotionRank;
+    while (promotions)
+        moves.add(PackedMove(from, popLsb(promotions), PackedMove::PROMOTION, QUEEN));
+
+    addMoves(from, targets & ~promotionRank, moves);
+}
+
+void MoveGenerator::addEnPassant(const Board &board, Color color, int kingSquare, Bitboard pawns, MoveList &moves)
+{
+    Color enemy = oppositeColor(color);
+    int target = board.getEnPassantSquare();
+    int captured = target + ((color == WHITE) ? -8 : 8);
+
+    if (captured < 0 || captured >= 64 || !(board.getPieces(PAWN, enemy) & squareBB(captured)))
+        return;
+
+    Bitboard capturers = Attacks::pawnAttacks(enemy, target) & pawns;
+    while (capturers)
+    {
+        int from = popLsb(capturers);
+
+        // Two pawns leave the rank at once, so test the resulting position directly
+        if (kingSquare >= 0)
+        {
+            Bitboard occupied = board.getOccupied() ^ squareBB(from) ^ squareBB(captured) ^ squareBB(target);
+            Bitboard attackers = attackersTo(board, kingSquare, occupied) & board.getPieces(enemy) & ~squareBB(captured);
+            if (attackers)
+                continue;
+        }
+
+        moves.add(PackedMove(from, target, PackedMove::EN_PASSANT));
+    }
+}
+
+void MoveGenerator::addCastling(const Board &board, Color color, int kingSquare, Bitboard danger, MoveList &moves)
+{
+    int rights = board.getCastlingRights();
+    int kingside = (color == WHITE) ? Zobrist::WHITE_KINGSIDE : Zobrist::BLACK_KINGSIDE;
+    int queenside = (color == WHITE) ? Zobrist::WHITE_QUEENSIDE : Zobrist::BLACK_QUEENSIDE;
+    int homeRow = (color == WHITE) ? 0 : 7;
+    Bitboard occupied = board.getOccupied();
+
+    if (kingSquare != squareIndex(homeRow, 4))
+        return;
+
+    if (rights & kingside)
+    {
+        Bitboard path = Attacks::between(kingSquare, squareIndex(homeRow, 7));
+        Bitboard kingPath = squareBB(squareIndex(homeRow, 5)) | squareBB(squareIndex(homeRow, 6));
+        if (!(path & occupied) && !(kingPath & danger))
+        {
+            moves.add(PackedMove(kingSquare, squareIndex(homeRow, 6), PackedMove::CASTLING));
+        }
+    }
+
+    if (rights & queenside)
+    {
+        Bitboard path = Attacks::between(kingSquare, squareIndex(homeRow, 0));
+        Bitboard kingPath = squareBB(squareIndex(homeRow, 3)) | squareBB(squareIndex(homeRow, 2));
+        if (!(path & occupied) && !(kingPath & danger))
+        {
+            moves.add(PackedMove(kingSquare, squareIndex(homeRow, 2), PackedMove::CASTLING));
+        }
+    }
+}
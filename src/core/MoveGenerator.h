@@ -0,0 +1,40 @@
+#ifndef MOVEGENERATOR_H
+#define MOVEGENERATOR_H
+
+#include "Board.h"
+#include "MoveList.h"
+#include "../utils/Types.h"
+#include "../utils/Bitboard.h"
+
+// Fully legal bitboard move generation. Pins and the check-evasion mask are
+// computed once per position, so no move has to be tried on the board.
+class MoveGenerator {
+public:
+    // Appends the legal moves of pieces on fromMask squares
+    static void generateLegalMoves(const Board& board, Color color, MoveList& moves,
+                                   Bitboard fromMask = ALL_SQUARES_BB);
+
+    // Appends only the legal captures, en passant included, and promotions
+    static void generateLegalCaptures(const Board& board, Color color, MoveList& moves);
+
+    // Pieces of both colors attacking square, with sliders seeing through to occupied
+    static Bitboard attackersTo(const Board& board, int square, Bitboard occupied);
+
+    // Every square attacked by color, sliders blocked by occupied
+    static Bitboard attackedSquares(const Board& board, Color color, Bitboard occupied);
+
+    // Pieces of color that are pinned to the king on kingSquare
+    static Bitboard pinnedPieces(const Board& board, Color color, int kingSquare);
+
+private:
+    static void generateMoves(const Board& board, Color color, MoveList& moves,
+                              Bitboard fromMask, bool capturesOnly);
+    static void addMoves(int from, Bitboard targets, MoveList& moves);
+    static void addPawnMoves(int from, Bitboard targets, Color color, MoveList& moves);
+    static void addEnPassant(const Board& board, Color color, int kingSquare, Bitboard pawns,
+                             MoveList& moves);
+    static void addCastling(const Board& board, Color color, int kingSquare, Bitboard danger,
+                            MoveList& moves);
+};
+
+#endif // MOVEGENERATOR_H
@@ -0,0 +1,71 @@
+#ifndef MOVELIST_H
+#define MOVELIST_H
+
+#include "PackedMove.h"
+#include <new>
+
+// Fixed-capacity move buffer meant to live on the stack. No chess position has
+// more than 218 legal moves, so 256 slots never overflow and never allocate.
+// Moves are stored packed, so a full list is 512 bytes.
+class MoveList {
+public:
+    static const int CAPACITY = 256;
+
+    MoveList() : count(0) {}
+
+    void add(PackedMove move) {
+        new (data() + count) PackedMove(move);
+        count++;
+    }
+
+    void clear() {
+        count = 0;
+    }
+
+    int size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    PackedMove& operator[](int index) {
+        return data()[index];
+    }
+
+    const PackedMove& operator[](int index) const {
+        return data()[index];
+    }
+
+    PackedMove* begin() {
+        return data();
+    }
+
+    PackedMove* end() {
+        return data() + count;
+    }
+
+    const PackedMove* begin() const {
+        return data();
+    }
+
+    const PackedMove* end() const {
+        return data() + count;
+    }
+
+private:
+    // Raw storage so constructing a list does not default-construct 256 moves
+    alignas(PackedMove) unsigned char storage[CAPACITY * sizeof(PackedMove)];
+    int count;
+
+    PackedMove* data() {
+        return reinterpret_cast<PackedMove*>(storage);
+    }
+
+    const PackedMove* data() const {
+        return reinterpret_cast<const PackedMove*>(storage);
+    }
+};
+
+#endif // MOVELIST_H
@@ -0,0 +1,46 @@
+#include "PackedMove.h"
+#include "Board.h"
+
+PackedMove PackedMove::fromMove(const Move& move) {
+    int from = squareIndex(move.getFrom());
+    int to = squareIndex(move.getTo());
+
+    if(move.isPromotionMove()) {
+        return PackedMove(from, to, PROMOTION, move.getPromotionPiece());
+    }
+    if(move.isEnPassantMove()) {
+        return PackedMove(from, to, EN_PASSANT);
+    }
+    if(move.isCastlingMove()) {
+        return PackedMove(from, to, CASTLING);
+    }
+    return PackedMove(from, to);
+}
+
+Move PackedMove::toMove(const Board& board) const {
+    Position from = getFrom();
+    Position to = getTo();
+    Move move(from, to, board.getPiece(from).getType(), getCapturedPiece(board));
+
+    switch(getKind()) {
+        case PROMOTION:
+            move.setPromotion(getPromotionPiece());
+            break;
+        case EN_PASSANT:
+            move.setEnPassant(true);
+            break;
+        case CASTLING:
+            move.setCastling(true);
+            break;
+        default:
+            break;
+    }
+    return move;
+}
+
+PieceType PackedMove::getCapturedPiece(const Board& board) const {
+    if(isEnPassantMove()) {
+        return PAWN;
+    }
+    return board.getPiece(getTo()).getType();
+}
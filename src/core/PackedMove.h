@@ -0,0 +1,101 @@
+#ifndef PACKEDMOVE_H
+#define PACKEDMOVE_H
+
+#include "Move.h"
+#include "../utils/Types.h"
+#include "../utils/Bitboard.h"
+#include <cstdint>
+
+class Board;
+
+// 16-bit move used by the search, the transposition table and move lists.
+// Bits 0-5 from square, 6-11 to square, 12-13 promotion piece (knight..queen),
+// 14-15 move kind. The moved and captured pieces are read back from the board.
+class PackedMove {
+public:
+    enum Kind {
+        NORMAL = 0,
+        PROMOTION = 1,
+        EN_PASSANT = 2,
+        CASTLING = 3
+    };
+
+    PackedMove() : data(0) {}
+
+    PackedMove(int from, int to, Kind kind = NORMAL, PieceType promotion = KNIGHT)
+        : data(static_cast<uint16_t>(from | (to << 6) | ((promotion - KNIGHT) << 12) | (kind << 14))) {}
+
+    PackedMove(Position from, Position to, Kind kind = NORMAL, PieceType promotion = KNIGHT)
+        : PackedMove(squareIndex(from), squareIndex(to), kind, promotion) {}
+
+    static PackedMove fromRaw(uint16_t raw) {
+        PackedMove move;
+        move.data = raw;
+        return move;
+    }
+
+    static PackedMove fromMove(const Move& move);
+
+    // Rebuilds the full Move, board must be the position the move is played from
+    Move toMove(const Board& board) const;
+
+    int getFromSquare() const {
+        return data & 0x3F;
+    }
+
+    int getToSquare() const {
+        return (data >> 6) & 0x3F;
+    }
+
+    Position getFrom() const {
+        return squareToPosition(getFromSquare());
+    }
+
+    Position getTo() const {
+        return squareToPosition(getToSquare());
+    }
+
+    Kind getKind() const {
+        return static_cast<Kind>(data >> 14);
+    }
+
+    PieceType getPromotionPiece() const {
+        return isPromotionMove() ? static_cast<PieceType>(KNIGHT + ((data >> 12) & 0x3)) : EMPTY;
+    }
+
+    PieceType getCapturedPiece(const Board& board) const;
+
+    bool isPromotionMove() const {
+        return getKind() == PROMOTION;
+    }
+
+    bool isEnPassantMove() const {
+        return getKind() == EN_PASSANT;
+    }
+
+    bool isCastlingMove() const {
+        return getKind() == CASTLING;
+    }
+
+    // a1a1 never occurs as a real move, so zero doubles as "no move"
+    bool isNull() const {
+        return data == 0;
+    }
+
+    uint16_t raw() const {
+        return data;
+    }
+
+    bool operator==(const PackedMove& other) const {
+        return data == other.data;
+    }
+
+    bool operator!=(const PackedMove& other) const {
+        return data != other.data;
+    }
+
+private:
+    uint16_t data;
+};
+
+#endif // PACKEDMOVE_H
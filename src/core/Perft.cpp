@@ -0,0 +1,165 @@
+#include "Perft.h"
+#include "GameRules.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+using namespace std;
+
+namespace {
+
+// Shared node-count cache, safe to use from several threads without locks.
+// Each slot stores (key ^ data, data) so a torn write never verifies.
+class PerftCache {
+private:
+    struct Entry {
+        atomic<uint64_t> check;
+        atomic<uint64_t> data;
+    };
+
+    unique_ptr<Entry[]> entries;
+    size_t mask;
+
+public:
+    PerftCache(int megabytes) {
+        size_t count = 1;
+        size_t bytes = static_cast<size_t>(megabytes) * 1024 * 1024;
+        while (count * 2 * sizeof(Entry) <= bytes) {
+            count *= 2;
+        }
+        entries.reset(new Entry[count]);
+        for (size_t i = 0; i < count; i++) {
+            entries[i].check.store(0, memory_order_relaxed);
+            entries[i].data.store(0, memory_order_relaxed);
+        }
+        mask = count - 1;
+    }
+
+    bool probe(uint64_t key, int depth, uint64_t& nodes) const {
+        const Entry& entry = entries[key & mask];
+        uint64_t data = entry.data.load(memory_order_relaxed);
+        uint64_t check = entry.check.load(memory_order_relaxed);
+        if ((check ^ data) != key || static_cast<int>(data & 0xFF) != depth) {
+            return false;
+        }
+        nodes = data >> 8;
+        return true;
+    }
+
+    void store(uint64_t key, int depth, uint64_t nodes) {
+        Entry& entry = entries[key & mask];
+        uint64_t data = (nodes << 8) | static_cast<uint64_t>(depth & 0xFF);
+        entry.data.store(data, memory_order_relaxed);
+        entry.check.store(key ^ data, memory_order_relaxed);
+    }
+};
+
+uint64_t perftNode(Board& board, Color color, int depth, PerftCache* cache) {
+    if (depth <= 0) {
+        return 1;
+    }
+
+    MoveList moves;
+    GameRules::getAllValidMoves(board, color, moves);
+    if (depth == 1) {
+        return moves.size();
+    }
+
+    uint64_t key = 0;
+    uint64_t nodes = 0;
+    if (cache) {
+        key = board.getZobristKey();
+        if (cache->probe(key, depth, nodes)) {
+            return nodes;
+        }
+    }
+
+    for (PackedMove move : moves) {
+        MoveUndo undo;
+        board.makeMove(move, undo);
+        nodes += perftNode(board, oppositeColor(color), depth - 1, cache);
+        board.unmakeMove(move, undo);
+    }
+
+    if (cache) {
+        cache->store(key, depth, nodes);
+    }
+    return nodes;
+}
+
+} // namespace
+
+uint64_t Perft::Result::nodesPerSecond() const {
+    if (seconds <= 0.0) {
+        return nodes;
+    }
+    return static_cast<uint64_t>(nodes / seconds);
+}
+
+uint64_t Perft::perft(Board& board, Color color, int depth) {
+    return perftNode(board, color, depth, nullptr);
+}
+
+Perft::Result Perft::divide(const Board& board, Color color, int depth,
+                            int threads, int cacheMB) {
+    auto start = chrono::steady_clock::now();
+
+    Result result;
+    result.depth = depth;
+    result.threads = threads < 1 ? 1 : threads;
+    result.nodes = 0;
+    result.seconds = 0.0;
+
+    Board root = board.copy();
+    MoveList moves;
+    GameRules::getAllValidMoves(root, color, moves);
+
+    if (depth <= 0) {
+        result.nodes = 1;
+        return result;
+    }
+
+    for (PackedMove move : moves) {
+        result.divide.push_back({move.toMove(root), 0});
+    }
+
+    unique_ptr<PerftCache> cache;
+    if (result.threads > 1 && depth > 2 && cacheMB > 0) {
+        cache.reset(new PerftCache(cacheMB));
+    }
+
+    // Workers pull root moves from a shared counter so long subtrees balance out
+    atomic<size_t> nextMove(0);
+    auto worker = [&]() {
+        while (true) {
+            size_t index = nextMove.fetch_add(1);
+            if (index >= static_cast<size_t>(moves.size())) {
+                break;
+            }
+            Board child = root.copy();
+            MoveUndo undo;
+            child.makeMove(moves[index], undo);
+            result.divide[index].nodes = perftNode(child, oppositeColor(color), depth - 1, cache.get());
+        }
+    };
+
+    if (result.threads == 1) {
+        worker();
+    } else {
+        vector<thread> pool;
+        for (int i = 0; i < result.threads; i++) {
+            pool.emplace_back(worker);
+        }
+        for (thread& t : pool) {
+            t.join();
+        }
+    }
+
+    for (const DivideEntry& entry : result.divide) {
+        result.nodes += entry.nodes;
+    }
+
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return result;
+}
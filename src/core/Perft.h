@@ -0,0 +1,35 @@
+#ifndef PERFT_H
+#define PERFT_H
+
+#include "Board.h"
+#include "Move.h"
+#include "../utils/Types.h"
+#include <cstdint>
+#include <vector>
+
+// Counts leaf nodes of the legal move tree to verify GameRules move generation
+class Perft {
+public:
+    struct DivideEntry {
+        Move move;
+        uint64_t nodes;
+    };
+
+    struct Result {
+        int depth;
+        int threads;
+        uint64_t nodes;
+        double seconds;
+        std::vector<DivideEntry> divide;
+
+        uint64_t nodesPerSecond() const;
+    };
+
+    static uint64_t perft(Board& board, Color color, int depth);
+
+    // Per-root-move counts; threads > 1 splits the root moves and shares a hashed node cache
+    static Result divide(const Board& board, Color color, int depth,
+                         int threads = 1, int cacheMB = 64);
+};
+
+#endif // PERFT_H
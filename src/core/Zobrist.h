@@ -0,0 +1,83 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include "../utils/Types.h"
+#include <cstdint>
+
+// Random keys for incremental position hashing, laid out like Polyglot:
+// 12 piece kinds x 64 squares, 4 castling rights, 8 en passant files, side to move.
+// The keys are generated at compile time from a fixed seed.
+struct ZobristKeys {
+    uint64_t piece[12][64];
+    uint64_t castling[4];
+    uint64_t enPassant[8];
+    uint64_t side;
+};
+
+constexpr uint64_t zobristSplitMix64(uint64_t& state) {
+    state += 0x9E3779B97F4A7C15ULL;
+    uint64_t z = state;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr ZobristKeys generateZobristKeys() {
+    ZobristKeys keys{};
+    uint64_t state = 0x43686573734B6579ULL;
+    for (int kind = 0; kind < 12; kind++) {
+        for (int square = 0; square < 64; square++) {
+            keys.piece[kind][square] = zobristSplitMix64(state);
+        }
+    }
+    for (int i = 0; i < 4; i++) {
+        keys.castling[i] = zobristSplitMix64(state);
+    }
+    for (int i = 0; i < 8; i++) {
+        keys.enPassant[i] = zobristSplitMix64(state);
+    }
+    keys.side = zobristSplitMix64(state);
+    return keys;
+}
+
+class Zobrist {
+public:
+    enum CastlingRight {
+        WHITE_KINGSIDE = 1,
+        WHITE_QUEENSIDE = 2,
+        BLACK_KINGSIDE = 4,
+        BLACK_QUEENSIDE = 8
+    };
+
+    // Polyglot piece kind: black pawn 0, white pawn 1, black knight 2, ... white king 11
+    static constexpr int pieceKind(PieceType type, Color color) {
+        return 2 * (static_cast<int>(type) - 1) + (color == WHITE ? 1 : 0);
+    }
+
+    static uint64_t pieceKey(PieceType type, Color color, int square) {
+        return KEYS.piece[pieceKind(type, color)][square];
+    }
+
+    static uint64_t castlingKey(int rights) {
+        uint64_t key = 0;
+        for (int i = 0; i < 4; i++) {
+            if (rights & (1 << i)) {
+                key ^= KEYS.castling[i];
+            }
+        }
+        return key;
+    }
+
+    static uint64_t enPassantKey(int square) {
+        return square < 0 ? 0 : KEYS.enPassant[square % 8];
+    }
+
+    static uint64_t sideKey() {
+        return KEYS.side;
+    }
+
+private:
+    static constexpr ZobristKeys KEYS = generateZobristKeys();
+};
+
+#endif // ZOBRIST_H
@@ -1,8 +1,10 @@
 #include "AI.h"
+#include "SearchWorker.h"
 #include "../core/GameRules.h"
 #include <algorithm>
-#include <limits>
 #include <iostream>
+#include <memory>
+#include <thread>
 #include <cstdlib>
 #include <ctime>
 
@@ -17,35 +19,61 @@ DifficultyConfig getConfig(Difficulty diff) {
             config.depth = 2;
             config.useTransTable = false;
             config.useAdvancedEval = false;
+            config.useQuiescence = false;
             config.randomness = 30;
+            config.useOpeningBook = false;
+            config.timeLimitMs = 250;
+            config.useNullMove = false;
+            config.useLateMoveReductions = false;
             break;
             
         case MEDIUM:
-            config.depth = 3;
+            config.depth = 4;
             config.useTransTable = true;
             config.useAdvancedEval = true;
+            config.useQuiescence = true;
             config.randomness = 10;
+            config.useOpeningBook = true;
+            config.timeLimitMs = 1000;
+            config.useNullMove = true;
+            config.useLateMoveReductions = true;
             break;
             
         case HARD:
-            config.depth = 4;
+            config.depth = 10;
             config.useTransTable = true;
             config.useAdvancedEval = true;
+            config.useQuiescence = true;
             config.randomness = 0;
+            config.useOpeningBook = true;
+            config.timeLimitMs = 2000;
+            config.useNullMove = true;
+            config.useLateMoveReductions = true;
             break;
     }
+    config.nodeLimit = 0;
+    config.nullMoveReduction = 2;
+    config.nullMoveMinDepth = 3;
+    config.lmrMinDepth = 3;
+    config.lmrMinMoves = 3;
+    config.lmrReduction = 1;
     
     return config;
 }
 
 AI::AI(Difficulty diff) {
+    timeLimitMs = 0;
+    nodeLimit = 0;
+    threadCount = 1;
     setDifficulty(diff);
-    nodesEvaluated = 0;
-    cacheHits = 0;
-    prunedBranches = 0;
+    resetStatistics();
     srand(time(0));
 }
 
+AI::~AI() {
+    stopPondering();
+}
+
 Move AI::getBestMove(Game& game, Color color, bool silent) {
     resetStatistics();
     
@@ -56,134 +84,185 @@ Move AI::getBestMove(Game& game, Color color, bool silent) {
         cout.flush();
     }
     
+    // A ponder search still on the board is a hit: take over its result
+    resolvePonder(game);
+    if (ponder) {
+        ponder->runner.join();
+        if (!silent) cout << " (ponder hit)";
+        Move move = collectResults(ponder->board, ponder->workers, silent);
+        ponder.reset();
+        return move;
+    }
+    
     Board board = game.getBoard().copy();
-    vector<Move> moves = GameRules::getAllValidMoves(board, color, game.getLastMove());
+    MoveList moves;
+    GameRules::getAllValidMoves(board, color, moves);
     
     if (moves.empty()) {
         if (!silent) cout << " No valid moves!\n";
         return Move();
     }
     
+    PackedMove fromBook;
+    if (config.useOpeningBook && openingBook.pickMove(board, fromBook)) {
+        bookMove = true;
+        principalVariation.push_back(fromBook.toMove(board));
+        if (!silent) cout << " (book move) Done! 📖\n";
+        return principalVariation[0];
+    }
+    
     if (config.randomness > 0) {
         int random = rand() % 100;
         if (random < config.randomness) {
             int randomIndex = rand() % moves.size();
             if (!silent) cout << " (random move) Done! 🎲\n";
-            return moves[randomIndex];
+            return moves[randomIndex].toMove(board);
         }
     }
     
-    moves = orderMoves(moves, board);
-    
-    Move bestMove = moves[0];
-    int bestScore = numeric_limits<int>::min();
-    int alpha = numeric_limits<int>::min();
-    int beta = numeric_limits<int>::max();
-    
-    for (Move& move : moves) {
-        Board tempBoard = board.copy();
-        tempBoard.executeMove(move);
-        int score = minimax(tempBoard, config.depth - 1, alpha, beta, 
-                           false, color, move, config);
-        
-        if (score > bestScore) {
-            bestScore = score;
-            bestMove = move;
-        }
-        
-        alpha = max(alpha, score);
-        
-        if (!silent) {
-            cout << ".";
-            cout.flush();
+    SearchWorker::orderMoves(moves, board);
+    
+    if (config.useTransTable) {
+        transTable.newSearch();
+    }
+    
+    // Lazy SMP: every thread searches the same root, sharing what it finds
+    // through the transposition table. The calling thread is worker 0.
+    SearchShared shared(transTable, config, color, silent);
+    vector<unique_ptr<SearchWorker>> workers;
+    for (int i = 0; i < threadCount; i++) {
+        workers.push_back(make_unique<SearchWorker>(i, shared));
+    }
+    runWorkers(board, moves, workers);
+    
+    return collectResults(board, workers, silent);
+}
+
+void AI::runWorkers(const Board& board, const MoveList& moves,
+                    vector<unique_ptr<SearchWorker>>& workers) {
+    vector<thread> helpers;
+    for (size_t i = 1; i < workers.size(); i++) {
+        helpers.emplace_back([&, i]() {
+            workers[i]->search(board, moves);
+        });
+    }
+    workers[0]->search(board, moves);
+    for (thread& helper : helpers) {
+        helper.join();
+    }
+}
+
+Move AI::collectResults(const Board& board, const vector<unique_ptr<SearchWorker>>& workers,
+                        bool silent) {
+    // Take the deepest completed iteration, preferring the main thread on ties
+    SearchWorker* best = workers[0].get();
+    for (const unique_ptr<SearchWorker>& worker : workers) {
+        nodesEvaluated += worker->getNodes();
+        quiescenceNodes += worker->getQuiescenceNodes();
+        cacheHits += worker->getCacheHits();
+        prunedBranches += worker->getPrunedBranches();
+        nullMoveCutoffs += worker->getNullMoveCutoffs();
+        futilityPrunes += worker->getFutilityPrunes();
+        razorPrunes += worker->getRazorPrunes();
+        deltaPrunes += worker->getDeltaPrunes();
+        seePrunes += worker->getSeePrunes();
+        bitbaseDraws += worker->getBitbaseDraws();
+        tableProbes += worker->getTableProbes();
+        tableHits += worker->getTableHits();
+        if (worker->getCompletedDepth() > best->getCompletedDepth()) {
+            best = worker.get();
         }
     }
+    completedDepth = best->getCompletedDepth();
+    
+    Board line = board.copy();
+    for (PackedMove move : best->getPrincipalVariation()) {
+        principalVariation.push_back(move.toMove(line));
+        MoveUndo undo;
+        line.makeMove(move, undo);
+    }
     
     if (!silent) {
         cout << " Done! ✓\n";
         printThinkingInfo();
     }
     
-    return bestMove;
+    return best->getBestMove().toMove(board);
 }
 
-int AI::minimax(Board& board, int depth, int alpha, int beta, 
-                bool isMaximizing, Color color, Move lastMove,
-                const DifficultyConfig& config) {
-    
-    nodesEvaluated++;
+bool AI::startPondering(const Game& game, Color color) {
+    stopPondering();
     
-    if (depth == 0) {
-        if (config.useAdvancedEval) {
-            return Evaluator::evaluate(board, color);
-        } else {
-            return Evaluator::evaluateMaterial(board) * (color == WHITE ? 1 : -1);
-        }
+    if (principalVariation.size() < 2) {
+        return false;
     }
     
-    if (config.useTransTable) {
-        string boardKey = TranspositionTable::generateKey(board);
-        int cachedScore;
-        if (transTable.lookup(boardKey, cachedScore)) {
-            cacheHits++;
-            return cachedScore;
-        }
-    }
-    
-    Color currentColor = isMaximizing ? color : oppositeColor(color);
+    unique_ptr<PonderSearch> search = make_unique<PonderSearch>();
+    search->board = game.getBoard().copy();
+    search->color = color;
+    search->predictedMove = principalVariation[1];
     
-    if (GameRules::isCheckmate(board, currentColor)) {
-        return isMaximizing ? -20000 + depth : 20000 - depth;
+    MoveUndo undo;
+    if (!search->board.makeMove(search->predictedMove, undo)) {
+        return false;
     }
-    
-    if (GameRules::isStalemate(board, currentColor)) {
-        return 0;
+    GameRules::getAllValidMoves(search->board, color, search->moves);
+    if (search->moves.empty()) {
+        return false;
     }
+    SearchWorker::orderMoves(search->moves, search->board);
     
-    vector<Move> moves = GameRules::getAllValidMoves(board, currentColor, lastMove);
+    DifficultyConfig config = getDifficultyConfig();
+    if (config.useTransTable) {
+        transTable.newSearch();
+    }
     
-    if (moves.empty()) {
-        return 0;
+    search->shared = make_unique<SearchShared>(transTable, config, color, true, true);
+    for (int i = 0; i < threadCount; i++) {
+        search->workers.push_back(make_unique<SearchWorker>(i, *search->shared));
     }
     
-    int bestScore;
-    
-    if (isMaximizing) {
-        bestScore = numeric_limits<int>::min();
-        for (Move& move : moves) {
-            Board tempBoard = board.copy();
-            tempBoard.executeMove(move);
-            int score = minimax(tempBoard, depth - 1, alpha, beta, 
-                               false, color, move, config);
-            bestScore = max(bestScore, score);
-            alpha = max(alpha, score);
-            if (beta <= alpha) {
-                prunedBranches++;
-                break;
-            }
-        }
-    } else {
-        bestScore = numeric_limits<int>::max();
-        for (Move& move : moves) {
-            Board tempBoard = board.copy();
-            tempBoard.executeMove(move);
-            int score = minimax(tempBoard, depth - 1, alpha, beta, 
-                               true, color, move, config);
-            bestScore = min(bestScore, score);
-            beta = min(beta, score);
-            if (beta <= alpha) {
-                prunedBranches++;
-                break;
-            }
-        }
+    PonderSearch* running = search.get();
+    search->runner = thread([running]() {
+        runWorkers(running->board, running->moves, running->workers);
+    });
+    ponder = move(search);
+    return true;
+}
+
+bool AI::resolvePonder(const Game& game) {
+    if (!ponder) {
+        return false;
     }
     
-    if (config.useTransTable) {
-        string boardKey = TranspositionTable::generateKey(board);
-        transTable.store(boardKey, bestScore);
+    const Board& board = game.getBoard();
+    if (board.getZobristKey() != ponder->board.getZobristKey() ||
+        game.getCurrentPlayer() != ponder->color) {
+        stopPondering();
+        return false;
     }
     
-    return bestScore;
+    // The time already spent pondering counts towards the budget, so a
+    // long think by the opponent leaves the move ready at once
+    ponder->shared->pondering.store(false, memory_order_relaxed);
+    return true;
+}
+
+void AI::stopPondering() {
+    if (!ponder) {
+        return;
+    }
+    ponder->shared->stop.store(true, memory_order_relaxed);
+    ponder->runner.join();
+    ponder.reset();
+}
+
+bool AI::isPondering() const {
+    return ponder != nullptr;
+}
+
+Move AI::getPonderMove() const {
+    return ponder ? ponder->predictedMove : Move();
 }
 
 void AI::setDifficulty(Difficulty diff) {
@@ -201,13 +280,53 @@ int AI::getMaxDepth() const {
 }
 
 DifficultyConfig AI::getDifficultyConfig() const {
-    return getConfig(difficulty);
+    DifficultyConfig config = getConfig(difficulty);
+    if (timeLimitMs > 0) {
+        config.timeLimitMs = timeLimitMs;
+    }
+    if (nodeLimit > 0) {
+        config.nodeLimit = nodeLimit;
+    }
+    return config;
+}
+
+void AI::setSearchLimits(int timeLimitMs, int nodeLimit) {
+    this->timeLimitMs = max(0, timeLimitMs);
+    this->nodeLimit = max(0, nodeLimit);
+}
+
+void AI::setHashSize(int sizeMB) {
+    transTable.resize(sizeMB);
+}
+
+bool AI::loadOpeningBook(const string& path) {
+    return openingBook.open(path);
+}
+
+void AI::setThreads(int threads) {
+    threadCount = max(1, threads);
+}
+
+int AI::getThreads() const {
+    return threadCount;
+}
+
+int AI::getTimeLimitMs() const {
+    return timeLimitMs;
+}
+
+int AI::getNodeLimit() const {
+    return nodeLimit;
 }
 
 int AI::getNodesEvaluated() const {
     return nodesEvaluated;
 }
 
+int AI::getQuiescenceNodes() const {
+    return quiescenceNodes;
+}
+
 int AI::getCacheHits() const {
     return cacheHits;
 }
@@ -216,10 +335,58 @@ int AI::getPrunedBranches() const {
     return prunedBranches;
 }
 
+int AI::getNullMoveCutoffs() const {
+    return nullMoveCutoffs;
+}
+
+int AI::getFutilityPrunes() const {
+    return futilityPrunes;
+}
+
+int AI::getRazorPrunes() const {
+    return razorPrunes;
+}
+
+int AI::getDeltaPrunes() const {
+    return deltaPrunes;
+}
+
+int AI::getSeePrunes() const {
+    return seePrunes;
+}
+
+int AI::getBitbaseDraws() const {
+    return bitbaseDraws;
+}
+
+int AI::getCompletedDepth() const {
+    return completedDepth;
+}
+
+const vector<Move>& AI::getPrincipalVariation() const {
+    return principalVariation;
+}
+
+bool AI::isBookMove() const {
+    return bookMove;
+}
+
 void AI::resetStatistics() {
     nodesEvaluated = 0;
+    quiescenceNodes = 0;
     cacheHits = 0;
     prunedBranches = 0;
+    nullMoveCutoffs = 0;
+    futilityPrunes = 0;
+    razorPrunes = 0;
+    deltaPrunes = 0;
+    seePrunes = 0;
+    bitbaseDraws = 0;
+    completedDepth = 0;
+    tableProbes = 0;
+    tableHits = 0;
+    principalVariation.clear();
+    bookMove = false;
 }
 
 void AI::printThinkingInfo() const {
@@ -235,10 +402,23 @@ void AI::printThinkingInfo() const {
     }
     cout << "                ║\n";
     
-    cout << "║ Search Depth: " << maxDepth << "                  ║\n";
+    cout << "║ Search Depth: " << completedDepth << "/" << maxDepth;
+    int padding = 18 - to_string(completedDepth).length() - to_string(maxDepth).length();
+    for (int i = 0; i < padding; i++) cout << " ";
+    cout << "║\n";
+    cout << "║ Threads: " << threadCount;
+    padding = 25 - to_string(threadCount).length();
+    for (int i = 0; i < padding; i++) cout << " ";
+    cout << "║\n";
+    
     cout << "║ Nodes Evaluated: " << nodesEvaluated;
     
-    int padding = 17 - to_string(nodesEvaluated).length();
+    padding = 17 - to_string(nodesEvaluated).length();
+    for (int i = 0; i < padding; i++) cout << " ";
+    cout << "║\n";
+    
+    cout << "║ Quiescence Nodes: " << quiescenceNodes;
+    padding = 16 - to_string(quiescenceNodes).length();
     for (int i = 0; i < padding; i++) cout << " ";
     cout << "║\n";
     
@@ -247,49 +427,46 @@ void AI::printThinkingInfo() const {
     for (int i = 0; i < padding; i++) cout << " ";
     cout << "║\n";
     
+    cout << "║ Bitbase Draws: " << bitbaseDraws;
+    padding = 19 - to_string(bitbaseDraws).length();
+    for (int i = 0; i < padding; i++) cout << " ";
+    cout << "║\n";
+    
     cout << "║ Branches Pruned: " << prunedBranches;
     padding = 17 - to_string(prunedBranches).length();
     for (int i = 0; i < padding; i++) cout << " ";
     cout << "║\n";
     
-    cout << "║ Cache Hit Rate: " << transTable.getHitRate() << "%";
-    padding = 18 - to_string((int)transTable.getHitRate()).length();
+    cout << "║   Null Move: " << nullMoveCutoffs;
+    padding = 21 - to_string(nullMoveCutoffs).length();
     for (int i = 0; i < padding; i++) cout << " ";
     cout << "║\n";
     
-    cout << "╚══════════════════════════════════╝\n\n";
-}
-
-vector<Move> AI::orderMoves(vector<Move>& moves, const Board& board) {
-    sort(moves.begin(), moves.end(), [&](const Move& a, const Move& b) {
-        int scoreA = 0;
-        int scoreB = 0;
-        
-        if (a.isCapture()) {
-            scoreA += 10 + Evaluator::getPieceValue(a.getCapturedPiece()) / 10;
-        }
-        if (b.isCapture()) {
-            scoreB += 10 + Evaluator::getPieceValue(b.getCapturedPiece()) / 10;
-        }
-        
-        if (a.isPromotionMove()) scoreA += 9;
-        if (b.isPromotionMove()) scoreB += 9;
-        
-        if (a.isCastlingMove()) scoreA += 5;
-        if (b.isCastlingMove()) scoreB += 5;
-        
-        Position toA = a.getTo();
-        Position toB = b.getTo();
-        
-        if ((toA.row >= 3 && toA.row <= 4) && (toA.col >= 3 && toA.col <= 4)) {
-            scoreA += 1;
-        }
-        if ((toB.row >= 3 && toB.row <= 4) && (toB.col >= 3 && toB.col <= 4)) {
-            scoreB += 1;
-        }
-        
-        return scoreA > scoreB;
-    });
+    cout << "║   Futility: " << futilityPrunes;
+    padding = 22 - to_string(futilityPrunes).length();
+    for (int i = 0; i < padding; i++) cout << " ";
+    cout << "║\n";
+    
+    cout << "║   Razoring: " << razorPrunes;
+    padding = 22 - to_string(razorPrunes).length();
+    for (int i = 0; i < padding; i++) cout << " ";
+    cout << "║\n";
+    
+    cout << "║   Delta: " << deltaPrunes;
+    padding = 25 - to_string(deltaPrunes).length();
+    for (int i = 0; i < padding; i++) cout << " ";
+    cout << "║\n";
     
-    return moves;
+    cout << "║   SEE: " << seePrunes;
+    padding = 27 - to_string(seePrunes).length();
+    for (int i = 0; i < padding; i++) cout << " ";
+    cout << "║\n";
+    
+    float hitRate = tableProbes > 0 ? (float)tableHits / tableProbes * 100.0f : 0.0f;
+    cout << "║ Cache Hit Rate: " << hitRate << "%";
+    padding = 18 - to_string((int)hitRate).length();
+    for (int i = 0; i < padding; i++) cout << " ";
+    cout << "║\n";
+    
+    cout << "╚══════════════════════════════════╝\n\n";
 }
@@ -3,8 +3,12 @@
 
 #include "../core/Game.h"
 #include "../core/Move.h"
+#include "../core/MoveList.h"
 #include "Evaluator.h"
+#include "OpeningBook.h"
 #include "TranspositionTable.h"
+#include <memory>
+#include <thread>
 #include <vector>
 
 enum Difficulty {
@@ -13,11 +17,32 @@ enum Difficulty {
     HARD = 2
 };
 
+struct SearchShared;
+class SearchWorker;
+
 struct DifficultyConfig {
-    int depth;
+    int depth;              // deepest iteration of iterative deepening
     bool useTransTable;
     bool useAdvancedEval;
+    bool useQuiescence;     // resolve captures at the leaves before evaluating
     int randomness;
+    bool useOpeningBook;    // play book moves while the position is in the book
+    int timeLimitMs;        // 0 = no time limit
+    int nodeLimit;          // 0 = no node limit
+
+    // Null-move pruning: give the opponent a free move and search the result
+    // nullMoveReduction plies shallower; still failing high proves a cutoff
+    bool useNullMove;
+    int nullMoveReduction;
+    int nullMoveMinDepth;
+
+    // Late move reductions: quiet moves from the lmrMinMoves-th on are first
+    // searched lmrReduction plies shallower, and again at full depth if they
+    // fail high
+    bool useLateMoveReductions;
+    int lmrMinDepth;
+    int lmrMinMoves;
+    int lmrReduction;
 };
 
 class AI {
@@ -25,24 +50,91 @@ private:
     Difficulty difficulty;
     int maxDepth;
     TranspositionTable transTable;
+    OpeningBook openingBook;
+    
+    // Budget overrides from setSearchLimits, 0 keeps the difficulty default
+    int timeLimitMs;
+    int nodeLimit;
+    int threadCount;
     
+    // Statistics of the last search, summed over all threads
     int nodesEvaluated;
+    int quiescenceNodes;
     int cacheHits;
     int prunedBranches;
+    int nullMoveCutoffs;
+    int futilityPrunes;
+    int razorPrunes;
+    int deltaPrunes;
+    int seePrunes;
+    int bitbaseDraws;
+    int completedDepth;
+    int tableProbes;
+    int tableHits;
+    vector<Move> principalVariation;
+    bool bookMove;
+    
+    // Search running on the opponent's time, on the position after the
+    // reply the last search predicted
+    struct PonderSearch {
+        Board board;
+        Color color;
+        Move predictedMove;
+        MoveList moves;
+        unique_ptr<SearchShared> shared;
+        vector<unique_ptr<SearchWorker>> workers;
+        thread runner;
+    };
+    unique_ptr<PonderSearch> ponder;
 
 public:
     AI(Difficulty diff = MEDIUM);
+    ~AI();
     
     Move getBestMove(Game& game, Color color, bool silent = false);    
-    int minimax(Board& board, int depth, int alpha, int beta, bool isMaximizing, Color color, Move lastMove, const DifficultyConfig& config);
+    
+    // Pondering: after the AI (color) has moved in game, search in the
+    // background as if the opponent had played the predicted reply, the
+    // second move of the principal variation. Returns false if there is none.
+    bool startPondering(const Game& game, Color color);
+    // Called once the opponent has moved. On a ponder hit the search goes on
+    // under the normal budget and getBestMove picks up its result; otherwise
+    // it is discarded. Its transposition table entries are kept either way.
+    bool resolvePonder(const Game& game);
+    void stopPondering();
+    bool isPondering() const;
+    Move getPonderMove() const;
     
     void setDifficulty(Difficulty diff);
     Difficulty getDifficulty() const;
     int getMaxDepth() const;
     
+    void setSearchLimits(int timeLimitMs, int nodeLimit);
+    void setHashSize(int sizeMB);
+    // Maps a book made by OpeningBook::build; false if the file is missing
+    bool loadOpeningBook(const string& path);
+    // Searches with this many threads (Lazy SMP) sharing one hash table
+    void setThreads(int threads);
+    int getThreads() const;
+    int getTimeLimitMs() const;
+    int getNodeLimit() const;
+    
     int getNodesEvaluated() const;
+    int getQuiescenceNodes() const;
     int getCacheHits() const;
     int getPrunedBranches() const;
+    // Parts of getPrunedBranches by reason; the rest are beta cutoffs
+    int getNullMoveCutoffs() const;
+    int getFutilityPrunes() const;
+    int getRazorPrunes() const;
+    int getDeltaPrunes() const;
+    int getSeePrunes() const;
+    int getBitbaseDraws() const;
+    int getCompletedDepth() const;
+    // Expected line of play from the last search, starting with the best move
+    const vector<Move>& getPrincipalVariation() const;
+    // True if the last move came from the opening book
+    bool isBookMove() const;
     void resetStatistics();
     
     void printThinkingInfo() const;
@@ -50,7 +142,12 @@ public:
 private:
     DifficultyConfig getDifficultyConfig() const;
     
-    std::vector<Move> orderMoves(std::vector<Move>& moves, const Board& board);
+    // Runs the workers on board: helpers on their own threads, worker 0 on this one
+    static void runWorkers(const Board& board, const MoveList& moves,
+                           vector<unique_ptr<SearchWorker>>& workers);
+    // Sums the workers' statistics and returns the deepest completed result
+    Move collectResults(const Board& board, const vector<unique_ptr<SearchWorker>>& workers,
+                        bool silent);
 };
 
 #endif // AI_H
\ No newline at end of file
@@ -0,0 +1,330 @@
+#include "EndgameBitbases.h"
+#include "../core/Attacks.h"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+MappedFile EndgameBitbases::file;
+
+namespace {
+
+enum Table {
+    KPK = 0,
+    KRK = 1,
+    KQK = 2,
+    TABLE_COUNT = 3
+};
+
+const char MAGIC[4] = {'E', 'G', 'B', '2'};      // 2: KPK without underpromotions
+const int POSITIONS = 2 * 64 * 64 * 64;
+const int TABLE_BYTES = POSITIONS / 8;
+
+// Position states while generating
+const uint8_t UNKNOWN = 0;      // a draw unless proven a win
+const uint8_t STRONG_WINS = 1;
+const uint8_t INVALID = 2;
+
+// weakToMove 0: the strong side (white) moves, 1: the lone king moves
+int positionIndex(int weakToMove, int strongKing, int weakKing, int piece) {
+    return ((weakToMove * 64 + strongKing) * 64 + weakKing) * 64 + piece;
+}
+
+PieceType tablePiece(int table) {
+    switch (table) {
+        case KPK: return PAWN;
+        case KRK: return ROOK;
+        default:  return QUEEN;
+    }
+}
+
+Bitboard pieceAttacks(PieceType type, int square, Bitboard occupied) {
+    switch (type) {
+        case PAWN: return Attacks::pawnAttacks(WHITE, square);
+        case ROOK: return Attacks::rookAttacks(square, occupied);
+        default:   return Attacks::queenAttacks(square, occupied);
+    }
+}
+
+// Splits the strong king's 64 squares over the threads; each thread only
+// writes the positions of its own squares
+void runParallel(int threads, const function<void(int, int)>& work) {
+    vector<thread> pool;
+    int chunk = (64 + threads - 1) / threads;
+    for (int begin = 0; begin < 64; begin += chunk) {
+        int end = begin + chunk < 64 ? begin + chunk : 64;
+        pool.emplace_back(work, begin, end);
+    }
+    for (thread& worker : pool) {
+        worker.join();
+    }
+}
+
+class Generator {
+public:
+    Generator(PieceType type, const vector<uint8_t>* queenTable)
+        : type(type), states(POSITIONS, UNKNOWN), queenTable(queenTable) {}
+
+    int run(int threads) {
+        runParallel(threads, [this](int begin, int end) { initialize(begin, end); });
+
+        // Each pass proves wins one ply further from mate or promotion;
+        // a pass that proves nothing new means every remaining position is a draw
+        int iterations = 0;
+        atomic<bool> changed(true);
+        while (changed) {
+            changed = false;
+            iterations++;
+            runParallel(threads, [&](int begin, int end) {
+                if (strongPass(begin, end)) changed = true;
+            });
+            runParallel(threads, [&](int begin, int end) {
+                if (weakPass(begin, end)) changed = true;
+            });
+        }
+        return iterations;
+    }
+
+    const vector<uint8_t>& getStates() const {
+        return states;
+    }
+
+private:
+    PieceType type;
+    vector<uint8_t> states;
+    const vector<uint8_t>* queenTable;      // finished KQK, for pawn promotions
+
+    bool isValid(int weakToMove, int strongKing, int weakKing, int piece) const {
+        if (strongKing == weakKing || strongKing == piece || weakKing == piece) {
+            return false;
+        }
+        if (Attacks::kingAttacks(strongKing) & squareBB(weakKing)) {
+            return false;
+        }
+        if (type == PAWN && (piece < 8 || piece >= 56)) {
+            return false;
+        }
+        // The side not to move cannot be in check
+        Bitboard occupied = squareBB(strongKing) | squareBB(weakKing) | squareBB(piece);
+        return weakToMove || !(pieceAttacks(type, piece, occupied) & squareBB(weakKing));
+    }
+
+    void initialize(int begin, int end) {
+        for (int strongKing = begin; strongKing < end; strongKing++) {
+            for (int weakKing = 0; weakKing < 64; weakKing++) {
+                for (int piece = 0; piece < 64; piece++) {
+                    for (int weakToMove = 0; weakToMove < 2; weakToMove++) {
+                        int index = positionIndex(weakToMove, strongKing, weakKing, piece);
+                        if (!isValid(weakToMove, strongKing, weakKing, piece)) {
+                            states[index] = INVALID;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Strong side to move: won if some move reaches a won position
+    bool strongPass(int begin, int end) {
+        bool changed = false;
+        for (int strongKing = begin; strongKing < end; strongKing++) {
+            for (int weakKing = 0; weakKing < 64; weakKing++) {
+                for (int piece = 0; piece < 64; piece++) {
+                    int index = positionIndex(0, strongKing, weakKing, piece);
+                    if (states[index] == UNKNOWN && strongCanWin(strongKing, weakKing, piece)) {
+                        states[index] = STRONG_WINS;
+                        changed = true;
+                    }
+                }
+            }
+        }
+        return changed;
+    }
+
+    bool strongCanWin(int strongKing, int weakKing, int piece) const {
+        Bitboard occupied = squareBB(strongKing) | squareBB(weakKing) | squareBB(piece);
+
+        Bitboard kingTargets = Attacks::kingAttacks(strongKing) & ~Attacks::kingAttacks(weakKing) & ~squareBB(piece);
+        while (kingTargets) {
+            int to = popLsb(kingTargets);
+            if (states[positionIndex(1, to, weakKing, piece)] == STRONG_WINS) {
+                return true;
+            }
+        }
+
+        if (type != PAWN) {
+            Bitboard targets = pieceAttacks(type, piece, occupied) & ~occupied;
+            while (targets) {
+                int to = popLsb(targets);
+                if (states[positionIndex(1, strongKing, weakKing, to)] == STRONG_WINS) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        int push = piece + 8;
+        if (occupied & squareBB(push)) {
+            return false;
+        }
+        if (push >= 56) {
+            // The move generator only promotes to a queen, so a win that
+            // needs an underpromotion is out of the engine's reach
+            return (*queenTable)[positionIndex(1, strongKing, weakKing, push)] == STRONG_WINS;
+        }
+        if (states[positionIndex(1, strongKing, weakKing, push)] == STRONG_WINS) {
+            return true;
+        }
+        int doublePush = piece + 16;
+        return piece < 16 && !(occupied & squareBB(doublePush)) &&
+               states[positionIndex(1, strongKing, weakKing, doublePush)] == STRONG_WINS;
+    }
+
+    // Lone king to move: lost if mated, or if every move reaches a won position
+    bool weakPass(int begin, int end) {
+        bool changed = false;
+        for (int strongKing = begin; strongKing < end; strongKing++) {
+            for (int weakKing = 0; weakKing < 64; weakKing++) {
+                for (int piece = 0; piece < 64; piece++) {
+                    int index = positionIndex(1, strongKing, weakKing, piece);
+                    if (states[index] == UNKNOWN && weakIsLost(strongKing, weakKing, piece)) {
+                        states[index] = STRONG_WINS;
+                        changed = true;
+                    }
+                }
+            }
+        }
+        return changed;
+    }
+
+    bool weakIsLost(int strongKing, int weakKing, int piece) const {
+        // Without the king on its square, so it cannot step back along a slider's line
+        Bitboard occupied = squareBB(strongKing) | squareBB(piece);
+        Bitboard attacked = Attacks::kingAttacks(strongKing) | pieceAttacks(type, piece, occupied);
+
+        Bitboard targets = Attacks::kingAttacks(weakKing) & ~attacked & ~squareBB(strongKing);
+        if (!targets) {
+            // Checkmate is lost, stalemate a draw
+            return (attacked & squareBB(weakKing)) != 0;
+        }
+
+        while (targets) {
+            int to = popLsb(targets);
+            // Taking the undefended piece leaves two bare kings
+            if (to == piece || states[positionIndex(0, strongKing, to, piece)] != STRONG_WINS) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+int countWins(const vector<uint8_t>& states) {
+    int wins = 0;
+    for (uint8_t state : states) {
+        if (state == STRONG_WINS) {
+            wins++;
+        }
+    }
+    return wins;
+}
+
+void writeTable(ofstream& out, const vector<uint8_t>& states) {
+    vector<char> bits(TABLE_BYTES, 0);
+    for (int index = 0; index < POSITIONS; index++) {
+        if (states[index] == STRONG_WINS) {
+            bits[index / 8] |= static_cast<char>(1 << (index % 8));
+        }
+    }
+    out.write(bits.data(), bits.size());
+}
+
+} // namespace
+
+EndgameBitbases::GenerateResult EndgameBitbases::generate(const string& path, int threads) {
+    GenerateResult result = {false, {0, 0, 0}, 0};
+    threads = threads < 1 ? 1 : (threads > 64 ? 64 : threads);
+
+    // The queen ending first, pawn promotions look it up
+    Generator queen(QUEEN, nullptr);
+    Generator rook(ROOK, nullptr);
+    result.iterations += queen.run(threads);
+    result.iterations += rook.run(threads);
+    Generator pawn(PAWN, &queen.getStates());
+    result.iterations += pawn.run(threads);
+
+    result.wins[KPK] = countWins(pawn.getStates());
+    result.wins[KRK] = countWins(rook.getStates());
+    result.wins[KQK] = countWins(queen.getStates());
+
+    ofstream out(path, ios::binary);
+    if (!out.is_open()) {
+        return result;
+    }
+    out.write(MAGIC, sizeof(MAGIC));
+    writeTable(out, pawn.getStates());
+    writeTable(out, rook.getStates());
+    writeTable(out, queen.getStates());
+    result.success = out.good();
+    return result;
+}
+
+bool EndgameBitbases::load(const string& path) {
+    if (!file.open(path)) {
+        return false;
+    }
+    if (file.size() != sizeof(MAGIC) + TABLE_COUNT * TABLE_BYTES ||
+        memcmp(file.data(), MAGIC, sizeof(MAGIC)) != 0) {
+        file.close();
+        return false;
+    }
+    return true;
+}
+
+bool EndgameBitbases::isLoaded() {
+    return file.isOpen();
+}
+
+bool EndgameBitbases::probe(const Board& board, Result& result) {
+    if (!file.isOpen() || popCount(board.getOccupied()) != 3) {
+        return false;
+    }
+
+    int table = -1;
+    Color strong = NONE;
+    Bitboard pieceBB = 0;
+    for (int i = KPK; i < TABLE_COUNT && table < 0; i++) {
+        for (Color color : {WHITE, BLACK}) {
+            Bitboard pieces = board.getPieces(tablePiece(i), color);
+            if (pieces) {
+                table = i;
+                strong = color;
+                pieceBB = pieces;
+            }
+        }
+    }
+    if (table < 0) {
+        return false;
+    }
+
+    // The tables see the strong side as white; mirror the ranks otherwise
+    int flip = (strong == WHITE) ? 0 : 56;
+    int strongKing = board.getKingSquare(strong) ^ flip;
+    int weakKing = board.getKingSquare(oppositeColor(strong)) ^ flip;
+    int piece = lsbIndex(pieceBB) ^ flip;
+    bool weakToMove = board.getSideToMove() != strong;
+
+    int index = positionIndex(weakToMove ? 1 : 0, strongKing, weakKing, piece);
+    const unsigned char* bits = file.data() + sizeof(MAGIC) + table * TABLE_BYTES;
+    if (!((bits[index / 8] >> (index % 8)) & 1)) {
+        result = DRAW;
+    } else {
+        result = weakToMove ? LOSS : WIN;
+    }
+    return true;
+}
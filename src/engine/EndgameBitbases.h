@@ -0,0 +1,48 @@
+#ifndef ENDGAMEBITBASES_H
+#define ENDGAMEBITBASES_H
+
+#include "../core/Board.h"
+#include "../utils/MappedFile.h"
+#include <string>
+
+using namespace std;
+
+// Win/draw/loss tables for king and pawn, rook or queen against a lone king.
+// Each table holds one bit per position (side to move x strong king x weak
+// king x piece, with the strong side's pieces always seen as white): set when
+// the strong side wins. A lone king can never win, so anything else is a draw.
+// Pawns promote to a queen only, like everywhere else in the engine.
+//
+// generate() computes them offline by retrograde analysis and writes one
+// small file; load() memory-maps it once at startup and probe() reads it.
+class EndgameBitbases {
+public:
+    enum Result {
+        LOSS = -1,
+        DRAW = 0,
+        WIN = 1
+    };
+
+    // Scores known wins below mate scores, so a mate the search can see
+    // still ranks above the table's verdict
+    static const int WIN_SCORE = 10000;
+
+    struct GenerateResult {
+        bool success;
+        int wins[3];        // won positions in KPK, KRK and KQK
+        int iterations;     // passes until no table changed
+    };
+
+    static GenerateResult generate(const string& path, int threads);
+    static bool load(const string& path);
+    static bool isLoaded();
+
+    // Result for the side to move; false if the position is not a
+    // three-piece ending covered by the tables, or none are loaded
+    static bool probe(const Board& board, Result& result);
+
+private:
+    static MappedFile file;
+};
+
+#endif // ENDGAMEBITBASES_H
@@ -1,144 +1,264 @@
 #include "Evaluator.h"
-#include "../core/GameRules.h"
+#include "../core/MoveGenerator.h"
+#include "../core/Attacks.h"
+#include "EndgameBitbases.h"
+#include "../utils/PieceSquareTables.h"
 #include <cmath>
+#include <cstring>
 
 using namespace std;
 
-int Evaluator::getPieceValue(PieceType type) {
+namespace {
+
+const Bitboard CENTER_BB = 0x00003C3C3C3C0000ULL;     // c3-f6
+
+// Per king-zone square a piece hits; the sum only fully counts once several
+// pieces join in, a lone attacker is rarely dangerous
+const int KING_ATTACK_WEIGHT[7] = {0, 0, 20, 20, 40, 80, 0};
+const int KING_ATTACK_SCALE[8] = {0, 0, 50, 75, 88, 94, 97, 99};
+
+const int CENTER_CONTROL_BONUS = 4;
+const int THREAT_BY_PAWN = 50;
+const int HANGING_PIECE = 30;
+
+Bitboard pieceAttacks(PieceType type, int square, Bitboard occupied) {
     switch (type) {
-        case PAWN:   return 100;
-        case KNIGHT: return 320;
-        case BISHOP: return 330;
-        case ROOK:   return 500;
-        case QUEEN:  return 900;
-        case KING:   return 20000;
-        default:     return 0;
+        case KNIGHT: return Attacks::knightAttacks(square);
+        case BISHOP: return Attacks::bishopAttacks(square, occupied);
+        case ROOK:   return Attacks::rookAttacks(square, occupied);
+        case QUEEN:  return Attacks::queenAttacks(square, occupied);
+        default:     return EMPTY_BB;
     }
 }
 
+} // namespace
+
+int Evaluator::getPieceValue(PieceType type) {
+    return PieceSquareTables::value(type);
+}
+
+int Evaluator::staticExchange(const Board& board, PackedMove move) {
+    int from = move.getFromSquare();
+    int to = move.getToSquare();
+    Piece mover = board.getPiece(move.getFrom());
+    Color side = mover.getColor();
+
+    // gain[d] is what the side making the d-th capture stands to win,
+    // assuming the piece it captures with is lost afterwards
+    int gain[32];
+    int depth = 0;
+    gain[0] = getPieceValue(move.getCapturedPiece(board));
+    PieceType onSquare = mover.getType();
+    if (move.isPromotionMove()) {
+        gain[0] += getPieceValue(move.getPromotionPiece()) - getPieceValue(PAWN);
+        onSquare = move.getPromotionPiece();
+    }
+
+    Bitboard occupied = board.getOccupied() & ~squareBB(from);
+    if (move.isEnPassantMove()) {
+        occupied &= ~squareBB(squareIndex(move.getFrom().row, move.getTo().col));
+    }
+
+    Bitboard attackers = MoveGenerator::attackersTo(board, to, occupied) & occupied;
+
+    while (depth < 31) {
+        side = oppositeColor(side);
+        Bitboard ours = attackers & board.getPieces(side);
+        if (!ours) {
+            break;
+        }
+
+        // Recapture with the least valuable attacker
+        PieceType type = PAWN;
+        Bitboard candidates = ours & board.getPieces(PAWN, side);
+        while (!candidates && type < KING) {
+            type = static_cast<PieceType>(type + 1);
+            candidates = ours & board.getPieces(type, side);
+        }
+
+        // The capturer leaves the square's lines, uncovering x-ray attackers
+        // of any kind, including a rook or queen behind a recapturing king
+        Bitboard remaining = occupied & ~squareBB(lsbIndex(candidates));
+        Bitboard nextAttackers = MoveGenerator::attackersTo(board, to, remaining) & remaining;
+
+        // The king may only recapture onto a square nothing defends any more
+        if (type == KING && (nextAttackers & board.getPieces(oppositeColor(side)))) {
+            break;
+        }
+
+        // A pawn recapturing on the last rank promotes to a queen
+        bool promotes = type == PAWN && (to < 8 || to >= 56);
+
+        // The recapturing side is behind whether it stops or recaptures, so
+        // the rest of the exchange cannot change who wins it
+        int next = getPieceValue(onSquare) - gain[depth];
+        if (promotes) {
+            next += getPieceValue(QUEEN) - getPieceValue(PAWN);
+        }
+        if (max(-gain[depth], next) < 0) {
+            break;
+        }
+        gain[++depth] = next;
+
+        occupied = remaining;
+        attackers = nextAttackers;
+        onSquare = promotes ? QUEEN : type;
+    }
+
+    // Each side only recaptures when that beats stopping
+    while (depth > 0) {
+        gain[depth - 1] = -max(-gain[depth - 1], gain[depth]);
+        depth--;
+    }
+    return gain[0];
+}
 
 int Evaluator::evaluate(const Board& board, Color perspective) {
     int score = 0;
     
+    if (evaluateKnownEnding(board, score)) {
+        return (perspective == WHITE) ? score : -score;
+    }
+
     score += evaluateMaterial(board);
     
-    score += evaluatePosition(board) / 2;
+    score += evaluatePosition(board);
     
-    int whiteMobility = evaluateMobility(board, WHITE);
-    int blackMobility = evaluateMobility(board, BLACK);
+    AttackMap attacks;
+    computeAttackMap(board, attacks);
+    
+    int whiteMobility = evaluateMobility(attacks, WHITE);
+    int blackMobility = evaluateMobility(attacks, BLACK);
     score += (whiteMobility - blackMobility) / 3;
     
-    int whiteKingSafety = evaluateKingSafety(board, WHITE);
-    int blackKingSafety = evaluateKingSafety(board, BLACK);
+    int whiteKingSafety = evaluateKingSafety(board, attacks, WHITE);
+    int blackKingSafety = evaluateKingSafety(board, attacks, BLACK);
     score += (whiteKingSafety - blackKingSafety) / 4;
+    
+    score += evaluateSquareControl(attacks, WHITE) - evaluateSquareControl(attacks, BLACK);
+    score += evaluateThreats(board, attacks, WHITE) - evaluateThreats(board, attacks, BLACK);
 
     score += evaluatePawnStructure(board) / 5;
     
     return (perspective == WHITE) ? score : -score;
 }
 
+// Three-piece endings the bitbases cover. A won one scores well above any
+// material count, plus terms that drive the lone king to the edge and the
+// strong king towards it so the search makes progress on the win.
+bool Evaluator::evaluateKnownEnding(const Board& board, int& score) {
+    EndgameBitbases::Result result;
+    if (!EndgameBitbases::probe(board, result)) {
+        return false;
+    }
+    if (result == EndgameBitbases::DRAW) {
+        score = 0;
+        return true;
+    }
 
-int Evaluator::evaluateMaterial(const Board& board) {
-    int score = 0;
-    
-    for (int row = 0; row < 8; row++) {
-        for (int col = 0; col < 8; col++) {
-            Piece piece = board.getPiece(row, col);
-            if (!piece.isEmpty()) {
-                int value = getPieceValue(piece.getType());
-                
-                if (piece.getColor() == WHITE) {
-                    score += value;
-                } else {
-                    score -= value;
-                }
-            }
-        }
+    Color sideToMove = board.getSideToMove();
+    Color strong = (result == EndgameBitbases::WIN) ? sideToMove : oppositeColor(sideToMove);
+    Position strongKing = squareToPosition(board.getKingSquare(strong));
+    Position weakKing = squareToPosition(board.getKingSquare(oppositeColor(strong)));
+
+    int edge = max(3 - weakKing.row, weakKing.row - 4) + max(3 - weakKing.col, weakKing.col - 4);
+    int kingDistance = max(abs(strongKing.row - weakKing.row), abs(strongKing.col - weakKing.col));
+
+    int winning = EndgameBitbases::WIN_SCORE + evaluateMaterial(board) * (strong == WHITE ? 1 : -1);
+    winning += edge * 10 + (7 - kingDistance) * 10;
+
+    Bitboard pawns = board.getPieces(PAWN, strong);
+    if (pawns) {
+        int row = squareToPosition(lsbIndex(pawns)).row;
+        winning += (strong == WHITE ? row : 7 - row) * 20;
     }
-    
-    return score;
+
+    score = (strong == WHITE) ? winning : -winning;
+    return true;
+}
+
+// Material and the piece-square sums are kept up to date by Board::setPiece
+// as moves are made and unmade
+int Evaluator::evaluateMaterial(const Board& board) {
+    return board.getMaterialScore();
 }
 
+// Blends the middlegame and endgame bonuses by how much material is left;
+// promotions can push the phase past the opening's, which still counts as
+// a middlegame
 int Evaluator::evaluatePosition(const Board& board) {
-    int score = 0;
-    
-    for (int row = 0; row < 8; row++) {
-        for (int col = 0; col < 8; col++) {
-            Piece piece = board.getPiece(row, col);
-            if (piece.isEmpty()) continue;
-            
-            Position pos(row, col);
-            int bonus = getPositionBonus(piece.getType(), pos, piece.getColor());
-            
-            if (piece.getColor() == WHITE) {
-                score += bonus;
-            } else {
-                score -= bonus;
-            }
-        }
-    }
-    
-    return score;
+    int phase = min(board.getPhase(), PieceSquareTables::MAX_PHASE);
+    return (board.getMiddlegameScore() * phase +
+            board.getEndgameScore() * (PieceSquareTables::MAX_PHASE - phase)) / PieceSquareTables::MAX_PHASE;
 }
 
 
-int Evaluator::evaluateMobility(const Board& board, Color color) {
+void Evaluator::computeAttackMap(const Board& board, AttackMap& attacks) {
+    memset(&attacks, 0, sizeof(attacks));
+    Bitboard occupied = board.getOccupied();
     
-    int mobilityScore = 0;
+    Bitboard whitePawns = board.getPieces(PAWN, WHITE);
+    Bitboard blackPawns = board.getPieces(PAWN, BLACK);
+    attacks.byType[WHITE][PAWN] = ((whitePawns & ~FILE_A_BB) << 7) | ((whitePawns & ~FILE_H_BB) << 9);
+    attacks.byType[BLACK][PAWN] = ((blackPawns & ~FILE_A_BB) >> 9) | ((blackPawns & ~FILE_H_BB) >> 7);
     
-    vector<Position> pieces = board.findAllPieces(color);
-    
-    for (const Position& pos : pieces) {
-        int mobility = calculatePieceMobility(board, pos);
-        mobilityScore += mobility;
+    for (Color color : {WHITE, BLACK}) {
+        Color enemy = oppositeColor(color);
+        Bitboard mobilityArea = ~board.getPieces(color) & ~attacks.byType[enemy][PAWN];
+        
+        int enemyKing = board.getKingSquare(enemy);
+        Bitboard kingZone = enemyKing >= 0 ? Attacks::kingAttacks(enemyKing) | squareBB(enemyKing) : EMPTY_BB;
+        
+        for (int type = KNIGHT; type <= QUEEN; type++) {
+            Bitboard pieces = board.getPieces(static_cast<PieceType>(type), color);
+            while (pieces) {
+                Bitboard targets = pieceAttacks(static_cast<PieceType>(type), popLsb(pieces), occupied);
+                attacks.byType[color][type] |= targets;
+                attacks.mobility[color] += popCount(targets & mobilityArea);
+                
+                if (targets & kingZone) {
+                    attacks.kingAttackers[enemy]++;
+                    attacks.kingAttackWeight[enemy] += KING_ATTACK_WEIGHT[type] * popCount(targets & kingZone);
+                }
+            }
+        }
+        
+        int king = board.getKingSquare(color);
+        if (king >= 0) {
+            attacks.byType[color][KING] = Attacks::kingAttacks(king);
+        }
+        
+        for (int type = PAWN; type <= KING; type++) {
+            attacks.all[color] |= attacks.byType[color][type];
+        }
     }
-    
-    return mobilityScore * 10;
 }
 
-int Evaluator::calculatePieceMobility(const Board& board, Position pos) {
-    
-    vector<Position> reachable = getReachableSquares(board, pos);
-    return reachable.size();
+int Evaluator::evaluateMobility(const AttackMap& attacks, Color color) {
+    return attacks.mobility[color] * 10;
 }
 
-vector<Position> Evaluator::getReachableSquares(const Board& board, Position pos) {
- 
-    vector<Position> reachable;
-    Piece piece = board.getPiece(pos);
-    
-    if (piece.isEmpty()) return reachable;
-    
-    Move dummyLastMove;
-    vector<Move> moves = GameRules::getPossibleMovesForPiece(board, pos, dummyLastMove);
-    
-    for (const Move& move : moves) {
-        reachable.push_back(move.getTo());
-    }
-    
-    return reachable;
+int Evaluator::countControlledSquares(const Board& board, Color color) {
+    return popCount(MoveGenerator::attackedSquares(board, color, board.getOccupied()));
 }
 
-bool Evaluator::isSquareControlled(const Board& board, Position pos, Color color) {
-    return GameRules::isSquareAttacked(board, pos, color);
+int Evaluator::evaluateSquareControl(const AttackMap& attacks, Color color) {
+    return popCount(attacks.all[color] & CENTER_BB) * CENTER_CONTROL_BONUS;
 }
 
-int Evaluator::countControlledSquares(const Board& board, Color color) {
-    int controlled = 0;
+// Enemy pieces this color's pawns attack, and ones it attacks that nothing defends
+int Evaluator::evaluateThreats(const Board& board, const AttackMap& attacks, Color color) {
+    Color enemy = oppositeColor(color);
+    Bitboard targets = board.getPieces(enemy) & ~board.getPieces(KING, enemy);
+    Bitboard pieces = targets & ~board.getPieces(PAWN, enemy);
     
-    for (int row = 0; row < 8; row++) {
-        for (int col = 0; col < 8; col++) {
-            Position pos(row, col);
-            if (isSquareControlled(board, pos, color)) {
-                controlled++;
-            }
-        }
-    }
+    int threats = popCount(attacks.byType[color][PAWN] & pieces) * THREAT_BY_PAWN;
+    threats += popCount(attacks.all[color] & ~attacks.all[enemy] & targets) * HANGING_PIECE;
     
-    return controlled;
+    return threats;
 }
 
-int Evaluator::evaluateKingSafety(const Board& board, Color color) {
+int Evaluator::evaluateKingSafety(const Board& board, const AttackMap& attacks, Color color) {
     Position kingPos = board.findKing(color);
     
     if (!kingPos.isValid()) {
@@ -171,6 +291,9 @@ int Evaluator::evaluateKingSafety(const Board& board, Color color) {
         }
     }
     
+    int attackers = min(attacks.kingAttackers[color], 7);
+    safety -= attacks.kingAttackWeight[color] * KING_ATTACK_SCALE[attackers] / 100;
+    
     return safety;
 }
 
@@ -209,46 +332,3 @@ int Evaluator::evaluatePawnStructure(const Board& board) {
     
     return score;
 }
-
-int Evaluator::getPositionBonus(PieceType type, Position pos, Color color) {
-    int row = (color == WHITE) ? pos.row : (7 - pos.row);
-    int col = pos.col;
-    
-    switch (type) {
-        case PAWN:
-            return row * 5;
-            
-        case KNIGHT:
-            if ((row == 3 || row == 4) && (col >= 2 && col <= 5)) {
-                return 30;  
-            }
-            if ((row == 2 || row == 5) && (col >= 2 && col <= 5)) {
-                return 15;  
-            }
-            return 0;
-            
-        case BISHOP:
-            if ((row == 3 || row == 4) && (col >= 2 && col <= 5)) {
-                return 20;
-            }
-            return 0;
-            
-        case ROOK:
-            if (row == 6) {
-                return 20;  
-            }
-            return 0;
-            
-        case QUEEN:
-            if ((row >= 2 && row <= 5) && (col >= 2 && col <= 5)) {
-                return 10;
-            }
-            return 0;
-            
-        case KING:
-            return 0;
-            
-        default:
-            return 0;
-    }
-}
\ No newline at end of file
@@ -2,26 +2,43 @@
 #define EVALUATOR_H
 
 #include "../core/Board.h"
+#include "../core/PackedMove.h"
 #include "../utils/Types.h"
-#include <vector>
 
 class Evaluator {
 public:
+    // Squares each side attacks, built in one bitboard pass per evaluation
+    // and shared by the mobility, king safety, control and threat terms
+    struct AttackMap {
+        Bitboard byType[3][7];      // attacked by that color's pieces of that type
+        Bitboard all[3];
+        int mobility[3];            // knight to queen moves, avoiding enemy pawn attacks
+        int kingAttackers[3];       // enemy pieces hitting the squares around this color's king
+        int kingAttackWeight[3];
+    };
+
     static int evaluate(const Board& board, Color perspective);
+    static void computeAttackMap(const Board& board, AttackMap& attacks);
     static int evaluateMaterial(const Board& board);
     static int evaluatePosition(const Board& board);
-    static int evaluateMobility(const Board& board, Color color);
-    static int evaluateKingSafety(const Board& board, Color color);
+    static int evaluateMobility(const AttackMap& attacks, Color color);
+    static int evaluateKingSafety(const Board& board, const AttackMap& attacks, Color color);
+    static int evaluateSquareControl(const AttackMap& attacks, Color color);
+    static int evaluateThreats(const Board& board, const AttackMap& attacks, Color color);
     static int evaluatePawnStructure(const Board& board);
 
     static int getPieceValue(PieceType type);
 
-    static int calculatePieceMobility(const Board& board, Position pos);
-    static vector<Position> getReachableSquares(const Board& board, Position pos);
-    static bool isSquareControlled(const Board& board, Position pos, Color color);
+    // Static exchange evaluation: material the side making the capture (or
+    // promotion) nets once both sides have recaptured on the target square
+    // with their least valuable pieces, each free to stop when behind.
+    // Sliders lined up behind the capturers join in as the square clears.
+    static int staticExchange(const Board& board, PackedMove move);
+
     static int countControlledSquares(const Board& board, Color color);
 
     private:
-    static int getPositionBonus(PieceType type, Position pos, Color color);
+    // Scores a KPK, KRK or KQK position from the endgame bitbases, white's view
+    static bool evaluateKnownEnding(const Board& board, int& score);
 };
 #endif // EVALUATOR_H
\ No newline at end of file
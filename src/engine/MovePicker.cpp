@@ -0,0 +1,82 @@
+#include "MovePicker.h"
+#include "Evaluator.h"
+#include "../core/MoveGenerator.h"
+
+using namespace std;
+
+MovePicker::MovePicker(const Board& board, Color color, PackedMove hashMove,
+                       const PackedMove* killers, const int (*history)[64])
+    : board(board), current(0) {
+    MoveGenerator::generateLegalMoves(board, color, moves);
+    scoreMoves(hashMove, killers, history);
+}
+
+MovePicker::MovePicker(const Board& board, Color color) : board(board), current(0) {
+    MoveGenerator::generateLegalCaptures(board, color, moves);
+    scoreMoves(PackedMove(), nullptr, nullptr);
+}
+
+int MovePicker::mvvLvaScore(const Board& board, PackedMove move) {
+    int victim = Evaluator::getPieceValue(move.getCapturedPiece(board));
+    if (move.isPromotionMove()) {
+        victim += Evaluator::getPieceValue(move.getPromotionPiece()) - Evaluator::getPieceValue(PAWN);
+    }
+    return victim * 8 - static_cast<int>(board.getPiece(move.getFrom()).getType());
+}
+
+int MovePicker::captureScore(const Board& board, PackedMove move) {
+    int score = mvvLvaScore(board, move);
+
+    // Taking a piece worth at least the capturer cannot lose material
+    PieceType attacker = board.getPiece(move.getFrom()).getType();
+    bool safe = !move.isPromotionMove() &&
+                Evaluator::getPieceValue(attacker) <= Evaluator::getPieceValue(move.getCapturedPiece(board));
+    if (safe || Evaluator::staticExchange(board, move) >= 0) {
+        return CAPTURE_SCORE + score;
+    }
+    return BAD_CAPTURE_SCORE + score;
+}
+
+void MovePicker::scoreMoves(PackedMove hashMove, const PackedMove* killers, const int (*history)[64]) {
+    for (int i = 0; i < moves.size(); i++) {
+        PackedMove move = moves[i];
+
+        if (move == hashMove) {
+            scores[i] = HASH_MOVE_SCORE;
+        } else if (move.getCapturedPiece(board) != EMPTY || move.isPromotionMove()) {
+            scores[i] = captureScore(board, move);
+        } else if (killers && move == killers[0]) {
+            scores[i] = FIRST_KILLER_SCORE;
+        } else if (killers && move == killers[1]) {
+            scores[i] = SECOND_KILLER_SCORE;
+        } else {
+            scores[i] = history ? history[move.getFromSquare()][move.getToSquare()] : 0;
+        }
+    }
+}
+
+bool MovePicker::next(PackedMove& move) {
+    if (current >= moves.size()) {
+        return false;
+    }
+
+    int best = current;
+    for (int i = current + 1; i < moves.size(); i++) {
+        if (scores[i] > scores[best]) {
+            best = i;
+        }
+    }
+
+    swap(moves[current], moves[best]);
+    swap(scores[current], scores[best]);
+    move = moves[current++];
+    return true;
+}
+
+int MovePicker::size() const {
+    return moves.size();
+}
+
+int MovePicker::getScore() const {
+    return scores[current - 1];
+}
@@ -0,0 +1,50 @@
+#ifndef MOVEPICKER_H
+#define MOVEPICKER_H
+
+#include "../core/Board.h"
+#include "../core/MoveList.h"
+#include "../core/PackedMove.h"
+
+// Generates the legal moves of a node and hands them out best first. Every
+// move is scored once up front; next() then selects the highest remaining
+// score, so a node that cuts off early never pays for sorting the rest.
+//
+// Order: hash move, captures and promotions that do not lose material by
+// MVV-LVA, the two killer moves of this ply, quiet moves by their history
+// score, then losing captures.
+class MovePicker {
+public:
+    static const int HASH_MOVE_SCORE = 1000000;
+    static const int CAPTURE_SCORE = 500000;
+    static const int FIRST_KILLER_SCORE = 400000;
+    static const int SECOND_KILLER_SCORE = 390000;
+    static const int BAD_CAPTURE_SCORE = -500000;
+
+    // All legal moves; killers and history may be null
+    MovePicker(const Board& board, Color color, PackedMove hashMove,
+               const PackedMove* killers, const int (*history)[64]);
+
+    // Captures and promotions only, for quiescence search
+    MovePicker(const Board& board, Color color);
+
+    bool next(PackedMove& move);
+    int size() const;
+    // Score of the move next() returned last; below zero for a losing capture
+    int getScore() const;
+
+    // Most valuable victim first, least valuable attacker breaking ties
+    static int mvvLvaScore(const Board& board, PackedMove move);
+    // MVV-LVA, offset so that captures losing material on exchange (by
+    // Evaluator::staticExchange) score below every other move
+    static int captureScore(const Board& board, PackedMove move);
+
+private:
+    const Board& board;
+    MoveList moves;
+    int scores[MoveList::CAPACITY];
+    int current;
+
+    void scoreMoves(PackedMove hashMove, const PackedMove* killers, const int (*history)[64]);
+};
+
+#endif // MOVEPICKER_H
@@ -0,0 +1,392 @@
+#include "OpeningBook.h"
+#include "PolyglotKeys.h"
+#include "../core/MoveGenerator.h"
+#include "../core/MoveList.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+using namespace std;
+
+namespace {
+
+uint64_t readBigEndian(const unsigned char* bytes, int count) {
+    uint64_t value = 0;
+    for (int i = 0; i < count; i++) {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+void writeBigEndian(ostream& out, uint64_t value, int count) {
+    for (int i = count - 1; i >= 0; i--) {
+        out.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+PieceType pieceFromLetter(char letter) {
+    switch (letter) {
+        case 'N': return KNIGHT;
+        case 'B': return BISHOP;
+        case 'R': return ROOK;
+        case 'Q': return QUEEN;
+        case 'K': return KING;
+        default:  return EMPTY;
+    }
+}
+
+bool isResultToken(const string& token) {
+    return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+}
+
+} // namespace
+
+bool OpeningBook::open(const string& path) {
+    return file.open(path);
+}
+
+void OpeningBook::close() {
+    file.close();
+}
+
+bool OpeningBook::isOpen() const {
+    return file.isOpen();
+}
+
+int OpeningBook::getEntryCount() const {
+    return static_cast<int>(file.size() / ENTRY_SIZE);
+}
+
+uint64_t OpeningBook::readKey(size_t index) const {
+    return readBigEndian(file.data() + index * ENTRY_SIZE, 8);
+}
+
+uint16_t OpeningBook::encodeMove(PackedMove move) {
+    int from = move.getFromSquare();
+    int to = move.getToSquare();
+    if (move.isCastlingMove()) {
+        Position king = move.getFrom();
+        to = squareIndex(king.row, move.getTo().col > king.col ? 7 : 0);
+    }
+
+    int promotion = 0;
+    if (move.isPromotionMove()) {
+        promotion = move.getPromotionPiece() - KNIGHT + 1;
+    }
+    return static_cast<uint16_t>(to | (from << 6) | (promotion << 12));
+}
+
+vector<OpeningBook::BookMove> OpeningBook::getMoves(const Board& board) const {
+    vector<BookMove> result;
+    if (!isOpen()) {
+        return result;
+    }
+
+    // First entry with the position's key
+    uint64_t key = PolyglotKeys::positionKey(board);
+    size_t low = 0;
+    size_t high = file.size() / ENTRY_SIZE;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (readKey(middle) < key) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    size_t count = file.size() / ENTRY_SIZE;
+    if (low == count || readKey(low) != key) {
+        return result;
+    }
+
+    // Book moves are matched against the legal moves, which also guards
+    // against key collisions
+    MoveList legalMoves;
+    MoveGenerator::generateLegalMoves(board, board.getSideToMove(), legalMoves);
+
+    for (size_t i = low; i < count && readKey(i) == key; i++) {
+        const unsigned char* entry = file.data() + i * ENTRY_SIZE;
+        uint16_t bookMove = static_cast<uint16_t>(readBigEndian(entry + 8, 2));
+        int weight = static_cast<int>(readBigEndian(entry + 10, 2));
+
+        for (PackedMove move : legalMoves) {
+            if (encodeMove(move) == bookMove) {
+                result.push_back({move, weight});
+                break;
+            }
+        }
+    }
+
+    sort(result.begin(), result.end(), [](const BookMove& a, const BookMove& b) {
+        return a.weight > b.weight;
+    });
+    return result;
+}
+
+bool OpeningBook::pickMove(const Board& board, PackedMove& move) const {
+    vector<BookMove> moves = getMoves(board);
+
+    int total = 0;
+    for (const BookMove& bookMove : moves) {
+        total += bookMove.weight;
+    }
+    if (total == 0) {
+        return false;
+    }
+
+    int pick = rand() % total;
+    for (const BookMove& bookMove : moves) {
+        pick -= bookMove.weight;
+        if (pick < 0) {
+            move = bookMove.move;
+            return true;
+        }
+    }
+    return false;
+}
+
+PackedMove OpeningBook::parseSan(const Board& board, const string& token) {
+    string san = token;
+    while (!san.empty() && strchr("+#!?", san.back())) {
+        san.pop_back();
+    }
+
+    MoveList moves;
+    MoveGenerator::generateLegalMoves(board, board.getSideToMove(), moves);
+
+    if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0") {
+        bool kingside = san.size() == 3;
+        for (PackedMove move : moves) {
+            if (move.isCastlingMove() && (move.getTo().col > move.getFrom().col) == kingside) {
+                return move;
+            }
+        }
+        return PackedMove();
+    }
+
+    // Promotion, written "e8=Q" or "e8Q"
+    PieceType promotion = EMPTY;
+    size_t equals = san.find('=');
+    if (equals != string::npos) {
+        promotion = equals + 1 < san.size() ? pieceFromLetter(san[equals + 1]) : EMPTY;
+        san = san.substr(0, equals);
+    } else if (san.size() > 2 && islower(static_cast<unsigned char>(san[0])) &&
+               pieceFromLetter(san.back()) != EMPTY) {
+        promotion = pieceFromLetter(san.back());
+        san.pop_back();
+    }
+
+    PieceType piece = PAWN;
+    size_t start = 0;
+    if (!san.empty() && pieceFromLetter(san[0]) != EMPTY) {
+        piece = pieceFromLetter(san[0]);
+        start = 1;
+    }
+    if (san.size() < start + 2) {
+        return PackedMove();
+    }
+
+    Position to = Position::fromString(san.substr(san.size() - 2));
+    if (!to.isValid()) {
+        return PackedMove();
+    }
+
+    // Whatever sits between the piece and the target square narrows down
+    // the origin: a file, a rank or both
+    string hint;
+    for (size_t i = start; i < san.size() - 2; i++) {
+        if (san[i] != 'x' && san[i] != '-') {
+            hint += san[i];
+        }
+    }
+
+    PackedMove found;
+    int matches = 0;
+    for (PackedMove move : moves) {
+        Position from = move.getFrom();
+        if (move.getTo() != to || board.getPiece(from).getType() != piece ||
+            move.getPromotionPiece() != promotion) {
+            continue;
+        }
+
+        bool fits = true;
+        for (char c : hint) {
+            if (c >= 'a' && c <= 'h') {
+                fits = fits && from.col == c - 'a';
+            } else if (c >= '1' && c <= '8') {
+                fits = fits && from.row == c - '1';
+            } else {
+                fits = false;
+            }
+        }
+        if (fits) {
+            found = move;
+            matches++;
+        }
+    }
+    return matches == 1 ? found : PackedMove();
+}
+
+OpeningBook::BuildResult OpeningBook::build(const string& pgnPath, const string& bookPath, int maxPly) {
+    BuildResult result = {false, 0, 0, 0, 0};
+
+    ifstream pgn(pgnPath);
+    if (!pgn.is_open()) {
+        return result;
+    }
+
+    // Weight per (key, move), ordered by key as the book file must be
+    map<pair<uint64_t, uint16_t>, uint32_t> weights;
+
+    Board board;
+    board.initializeBoard();
+    vector<pair<uint64_t, uint16_t>> played;
+    bool usable = true;
+    bool hasMoves = false;
+
+    auto finishGame = [&](const string& outcome) {
+        if (usable && outcome != "*" && !played.empty()) {
+            for (size_t ply = 0; ply < played.size(); ply++) {
+                bool whiteMoved = (ply % 2 == 0);
+                int score = 1;
+                if (outcome == "1-0") {
+                    score = whiteMoved ? 2 : 0;
+                } else if (outcome == "0-1") {
+                    score = whiteMoved ? 0 : 2;
+                }
+                if (score > 0) {
+                    weights[played[ply]] += score;
+                }
+            }
+            result.games++;
+        } else if (hasMoves || !usable) {
+            result.skippedGames++;
+        }
+
+        board = Board();
+        board.initializeBoard();
+        played.clear();
+        usable = true;
+        hasMoves = false;
+    };
+
+    auto handleToken = [&](string token) {
+        if (isResultToken(token)) {
+            finishGame(token);
+            return;
+        }
+        if (token[0] == '$' || token == "e.p.") {
+            return;
+        }
+
+        // Move numbers, "12." or "12...", possibly glued to the move
+        size_t start = 0;
+        while (start < token.size() && isdigit(static_cast<unsigned char>(token[start]))) {
+            start++;
+        }
+        if (start > 0 && start < token.size() && token[start] == '.') {
+            while (start < token.size() && token[start] == '.') {
+                start++;
+            }
+            token = token.substr(start);
+        }
+        if (token.empty()) {
+            return;
+        }
+
+        hasMoves = true;
+        if (!usable || static_cast<int>(played.size()) >= maxPly) {
+            return;
+        }
+
+        PackedMove move = parseSan(board, token);
+        if (move.isNull()) {
+            usable = false;
+            return;
+        }
+        played.push_back({PolyglotKeys::positionKey(board), encodeMove(move)});
+        MoveUndo undo;
+        board.makeMove(move, undo);
+    };
+
+    // Comments and variations may span lines, so their state carries over
+    bool inComment = false;
+    int variationDepth = 0;
+    string line;
+    while (getline(pgn, line)) {
+        if (!inComment && variationDepth == 0 && !line.empty() && line[0] == '[') {
+            // Games from a set-up position do not start from the book's root
+            if (line.compare(0, 4, "[FEN") == 0) {
+                usable = false;
+            }
+            continue;
+        }
+
+        // One step past the end reads as a space, ending the last token
+        string token;
+        for (size_t i = 0; i <= line.size(); i++) {
+            char c = i < line.size() ? line[i] : ' ';
+
+            if (inComment) {
+                inComment = (c != '}');
+                continue;
+            }
+            if (c == ';') {
+                break;
+            }
+            if (c == '{' || c == '(' || c == ')' || isspace(static_cast<unsigned char>(c))) {
+                if (!token.empty() && variationDepth == 0) {
+                    handleToken(token);
+                }
+                token.clear();
+
+                if (c == '{') {
+                    inComment = true;
+                } else if (c == '(') {
+                    variationDepth++;
+                } else if (c == ')' && variationDepth > 0) {
+                    variationDepth--;
+                }
+                continue;
+            }
+            token += c;
+        }
+    }
+    finishGame("*");
+
+    ofstream book(bookPath, ios::binary);
+    if (!book.is_open()) {
+        return result;
+    }
+
+    auto it = weights.begin();
+    while (it != weights.end()) {
+        uint64_t key = it->first.first;
+        vector<pair<uint32_t, uint16_t>> moves;
+        for (; it != weights.end() && it->first.first == key; ++it) {
+            moves.push_back({it->second, it->first.second});
+        }
+        sort(moves.begin(), moves.end(), [](const pair<uint32_t, uint16_t>& a, const pair<uint32_t, uint16_t>& b) {
+            return a.first > b.first;
+        });
+
+        // Weights are 16 bits; scale a position's moves down together if needed
+        uint32_t top = moves[0].first;
+        for (const pair<uint32_t, uint16_t>& move : moves) {
+            uint32_t weight = top > 0xFFFF ? static_cast<uint32_t>(static_cast<uint64_t>(move.first) * 0xFFFF / top) : move.first;
+            writeBigEndian(book, key, 8);
+            writeBigEndian(book, move.second, 2);
+            writeBigEndian(book, max<uint32_t>(weight, 1), 2);
+            writeBigEndian(book, 0, 4);
+            result.entries++;
+        }
+        result.positions++;
+    }
+
+    result.success = book.good();
+    return result;
+}
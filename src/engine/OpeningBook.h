@@ -0,0 +1,66 @@
+#ifndef OPENINGBOOK_H
+#define OPENINGBOOK_H
+
+#include "../core/Board.h"
+#include "../core/PackedMove.h"
+#include "../utils/MappedFile.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Opening book in the Polyglot .bin format: 16-byte big-endian entries of
+// key, move, weight and learn, sorted by key. The file is memory-mapped and
+// binary-searched in place, so opening it costs nothing until it is probed.
+//
+// Keys are Polyglot's own (see PolyglotKeys), so third-party Polyglot books
+// can be probed as well as the ones made with build().
+class OpeningBook {
+public:
+    struct BookMove {
+        PackedMove move;
+        int weight;
+    };
+
+    struct BuildResult {
+        bool success;
+        int games;          // games whose moves went into the book
+        int skippedGames;   // unfinished games, games from a set-up position, unreadable moves
+        int positions;
+        int entries;
+    };
+
+    bool open(const string& path);
+    void close();
+    bool isOpen() const;
+    int getEntryCount() const;
+
+    // Book moves for the side to move, highest weight first
+    vector<BookMove> getMoves(const Board& board) const;
+    // Picks a book move at random, in proportion to the weights; false if
+    // the position is not in the book
+    bool pickMove(const Board& board, PackedMove& move) const;
+
+    // Streams a PGN collection game by game and writes a book of the moves
+    // played in the first maxPly plies. A move is weighted 2 per win and 1
+    // per draw for the side that played it; moves that only lost are left out.
+    static BuildResult build(const string& pgnPath, const string& bookPath, int maxPly = 16);
+
+    // Polyglot move: to square in bits 0-5, from square in bits 6-11,
+    // promotion (1 knight .. 4 queen) in bits 12-14. Castling is written as
+    // the king taking its own rook.
+    static uint16_t encodeMove(PackedMove move);
+
+private:
+    static const int ENTRY_SIZE = 16;
+
+    MappedFile file;
+
+    uint64_t readKey(size_t index) const;
+
+    // Resolves one SAN token ("Nbd7", "exd6", "O-O", "e8=Q+") against the legal moves
+    static PackedMove parseSan(const Board& board, const string& san);
+};
+
+#endif // OPENINGBOOK_H
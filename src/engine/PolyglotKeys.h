@@ -0,0 +1,15 @@
+#ifndef POLYGLOTKEYS_H
+#define POLYGLOTKEYS_H
+
+#include "../core/Board.h"
+#include <cstdint>
+
+// Position keys from Polyglot's published random numbers, the keys every
+// Polyglot .bin book is sorted by. The search keeps the board's own Zobrist
+// keys; these are computed from scratch and only used to probe and build books.
+class PolyglotKeys {
+public:
+    static uint64_t positionKey(const Board& board);
+};
+
+#endif // POLYGLOTKEYS_H
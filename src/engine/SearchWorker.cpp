@@ -0,0 +1,568 @@
+#include "SearchWorker.h"
+#include "Evaluator.h"
+#include "MovePicker.h"
+#include "EndgameBitbases.h"
+#include "../core/GameRules.h"
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+
+using namespace std;
+
+SearchWorker::SearchWorker(int id, SearchShared& shared) : id(id), shared(shared) {
+    bestScore = 0;
+    completedDepth = 0;
+    stopped = false;
+    nodes = 0;
+    quiescenceNodes = 0;
+    flushedNodes = 0;
+    cacheHits = 0;
+    prunedBranches = 0;
+    nullMoveCutoffs = 0;
+    futilityPrunes = 0;
+    razorPrunes = 0;
+    deltaPrunes = 0;
+    seePrunes = 0;
+    bitbaseDraws = 0;
+    tableProbes = 0;
+    tableHits = 0;
+    memset(history, 0, sizeof(history));
+    memset(pvLength, 0, sizeof(pvLength));
+}
+
+void SearchWorker::search(const Board& root, const MoveList& rootMoves) {
+    const DifficultyConfig& config = shared.config;
+    board = root.copy();
+
+    MoveList moves = rootMoves;
+    bestMove = moves[0];
+
+    // Helpers start from a different root move and odd ones skip every other
+    // depth, so the threads spread out over the tree instead of duplicating it
+    if (id > 0) {
+        rotate(moves.begin(), moves.begin() + id % moves.size(), moves.end());
+    }
+    int depthStep = (id % 2 == 1) ? 2 : 1;
+
+    // Iterative deepening: each completed iteration replaces the best move and
+    // is searched first in the next one. An iteration cut short by the time or
+    // node budget is thrown away.
+    for (int depth = 1 + id % 2; depth <= config.depth; depth += depthStep) {
+        // Aspiration window: expect a score close to the last iteration's and
+        // widen the side that fails until the score lands inside
+        int delta = ASPIRATION_WINDOW;
+        int alpha = -INFINITE_SCORE;
+        int beta = INFINITE_SCORE;
+        if (completedDepth > 0 && depth >= ASPIRATION_DEPTH &&
+            abs(bestScore) < TranspositionTable::MATE_THRESHOLD) {
+            alpha = max(bestScore - delta, -INFINITE_SCORE);
+            beta = min(bestScore + delta, INFINITE_SCORE);
+        }
+
+        int score;
+        while (true) {
+            score = searchRoot(moves, depth, alpha, beta);
+            if (stopped) {
+                break;
+            }
+
+            if (score <= alpha) {
+                alpha = max(alpha - delta, -INFINITE_SCORE);
+            } else if (score >= beta) {
+                beta = min(beta + delta, INFINITE_SCORE);
+            } else {
+                break;
+            }
+            delta *= 2;
+        }
+
+        if (stopped) {
+            break;
+        }
+
+        bestMove = moves[0];
+        bestScore = score;
+        completedDepth = depth;
+        principalVariation = MoveList();
+        for (int i = 0; i < pvLength[0]; i++) {
+            principalVariation.add(pvTable[0][i]);
+        }
+
+        if (id == 0) {
+            if (!shared.silent) {
+                cout << ".";
+                cout.flush();
+            }
+
+            // The next iteration takes several times longer, so don't start one
+            // that could not finish within the budget
+            if (config.timeLimitMs > 0 && !shared.pondering.load(memory_order_relaxed) &&
+                elapsedMs() * 2 >= config.timeLimitMs) {
+                break;
+            }
+        }
+    }
+
+    // The main thread's search ending ends everyone's
+    if (id == 0) {
+        shared.stop.store(true, memory_order_relaxed);
+    }
+    shared.nodes.fetch_add(nodes + quiescenceNodes - flushedNodes, memory_order_relaxed);
+    flushedNodes = nodes + quiescenceNodes;
+}
+
+int SearchWorker::searchRoot(MoveList& moves, int depth, int alpha, int beta) {
+    int bestScore = -INFINITE_SCORE;
+    PackedMove* best = moves.begin();
+    pvLength[0] = 0;
+
+    for (PackedMove* it = moves.begin(); it != moves.end(); ++it) {
+        PackedMove move = *it;
+        MoveUndo undo;
+        board.makeMove(move, undo);
+        int score;
+        if (it == moves.begin()) {
+            score = -negamax(depth - 1, -beta, -alpha, 1, true);
+        } else {
+            // Later moves only need to be proven worse than the best so far,
+            // which a null window does cheaply; the rare one that is not gets
+            // searched again in the full window
+            score = -negamax(depth - 1, -alpha - 1, -alpha, 1, true);
+            if (score > alpha && score < beta) {
+                score = -negamax(depth - 1, -beta, -alpha, 1, true);
+            }
+        }
+        board.unmakeMove(move, undo);
+
+        if (stopped) {
+            break;
+        }
+
+        if (score > bestScore) {
+            bestScore = score;
+            best = it;
+        }
+        if (score > alpha) {
+            alpha = score;
+            updatePrincipalVariation(move, 0);
+        }
+        if (alpha >= beta) {
+            break;
+        }
+    }
+
+    rotate(moves.begin(), best, best + 1);
+    return bestScore;
+}
+
+int SearchWorker::negamax(int depth, int alpha, int beta, int ply, bool allowNullMove) {
+    const DifficultyConfig& config = shared.config;
+
+    nodes++;
+
+    if (ply >= MAX_PLY) {
+        return evaluate(ply);
+    }
+    pvLength[ply] = ply;
+
+    if (shouldStop()) {
+        return 0;
+    }
+
+    // A drawn bitbase ending needs no search; won ones are still searched so
+    // the engine finds the moves that make progress
+    EndgameBitbases::Result ending;
+    if (ply > 0 && EndgameBitbases::probe(board, ending) && ending == EndgameBitbases::DRAW) {
+        bitbaseDraws++;
+        return 0;
+    }
+
+    if (depth == 0) {
+        if (config.useQuiescence) {
+            // The leaf was counted as a search node, quiescence counts its own
+            nodes--;
+            return quiescence(alpha, beta, ply);
+        }
+        return evaluate(ply);
+    }
+
+    uint64_t boardKey = 0;
+    PackedMove hashMove;
+    if (config.useTransTable) {
+        boardKey = TranspositionTable::generateKey(board);
+        TranspositionTable::ProbeResult cached;
+        tableProbes++;
+        if (shared.transTable.probe(boardKey, ply, cached)) {
+            tableHits++;
+            hashMove = cached.bestMove;
+            if (cached.depth >= depth &&
+                (cached.bound == TranspositionTable::BOUND_EXACT ||
+                 (cached.bound == TranspositionTable::BOUND_LOWER && cached.score >= beta) ||
+                 (cached.bound == TranspositionTable::BOUND_UPPER && cached.score <= alpha))) {
+                cacheHits++;
+                return cached.score;
+            }
+        }
+    }
+
+    Color currentColor = sideToMove(ply);
+    bool inCheck = GameRules::isKingInCheck(board, currentColor);
+    bool pvNode = beta - alpha > 1;
+
+    // The pruning below is unsound in check and too risky on the principal variation
+    bool canPrune = !pvNode && !inCheck;
+    int staticEval = canPrune ? evaluate(ply) : 0;
+
+    // Razoring: far below alpha near the leaves, only a capture can save the
+    // node, so let quiescence decide whether it is worth searching at all
+    if (canPrune && config.useQuiescence && depth <= FRONTIER_DEPTH &&
+        staticEval + RAZOR_MARGIN * depth <= alpha) {
+        int razorAlpha = alpha - RAZOR_MARGIN * depth;
+        int score = quiescence(razorAlpha, razorAlpha + 1, ply);
+        if (stopped) {
+            return 0;
+        }
+        if (score <= razorAlpha) {
+            prunedBranches++;
+            razorPrunes++;
+            return score;
+        }
+    }
+
+    // Null move: if passing still fails high, a real move would too. Not
+    // tried twice in a row or with only pawns left.
+    if (config.useNullMove && allowNullMove && canPrune &&
+        depth >= config.nullMoveMinDepth && hasNonPawnMaterial(currentColor) &&
+        staticEval >= beta) {
+        MoveUndo undo;
+        board.makeNullMove(undo);
+        int score = -negamax(max(depth - 1 - config.nullMoveReduction, 0), -beta, -beta + 1, ply + 1, false);
+        board.unmakeNullMove(undo);
+
+        if (stopped) {
+            return 0;
+        }
+        if (score >= beta) {
+            prunedBranches++;
+            nullMoveCutoffs++;
+            // A mate found after passing is not a proven mate
+            return score >= TranspositionTable::MATE_THRESHOLD ? beta : score;
+        }
+    }
+
+    MovePicker picker(board, currentColor, hashMove, killers[ply], history[currentColor - 1]);
+
+    // No legal moves: checkmate if the side to move is in check, stalemate otherwise
+    if (picker.size() == 0) {
+        if (inCheck) {
+            return -MATE_SCORE + ply;
+        }
+        return 0;
+    }
+
+    // Futility: near the leaves, quiet moves cannot lift a hopeless eval to alpha
+    bool futile = canPrune && depth <= FRONTIER_DEPTH &&
+                  abs(alpha) < TranspositionTable::MATE_THRESHOLD &&
+                  staticEval + FUTILITY_MARGIN * depth <= alpha;
+
+    int alphaOrig = alpha;
+    int bestScore = -INFINITE_SCORE;
+    PackedMove bestMove;
+    PackedMove move;
+    int moveCount = 0;
+
+    while (picker.next(move)) {
+        bool quiet = move.getCapturedPiece(board) == EMPTY && !move.isPromotionMove();
+
+        MoveUndo undo;
+        board.makeMove(move, undo);
+
+        // The first move is always searched so the node has a real score;
+        // checks are kept since they may be all that saves the position
+        if (futile && quiet && moveCount > 0 &&
+            !GameRules::isKingInCheck(board, oppositeColor(currentColor))) {
+            board.unmakeMove(move, undo);
+            prunedBranches++;
+            futilityPrunes++;
+            continue;
+        }
+
+        moveCount++;
+        int score;
+        if (moveCount == 1) {
+            score = -negamax(depth - 1, -beta, -alpha, ply + 1, true);
+        } else {
+            // Late quiet moves rarely turn out best, so they get a shallower
+            // null-window search first; checks and check evasions are exempt
+            int reduction = 0;
+            if (config.useLateMoveReductions && quiet && !inCheck &&
+                depth >= config.lmrMinDepth && moveCount > config.lmrMinMoves &&
+                !GameRules::isKingInCheck(board, oppositeColor(currentColor))) {
+                reduction = config.lmrReduction + (moveCount > 3 * config.lmrMinMoves ? 1 : 0);
+                reduction = min(reduction, depth - 1);
+            }
+
+            score = -negamax(depth - 1 - reduction, -alpha - 1, -alpha, ply + 1, true);
+            if (reduction > 0 && score > alpha) {
+                score = -negamax(depth - 1, -alpha - 1, -alpha, ply + 1, true);
+            }
+            if (score > alpha && score < beta) {
+                score = -negamax(depth - 1, -beta, -alpha, ply + 1, true);
+            }
+        }
+        board.unmakeMove(move, undo);
+
+        // The child's score is made up once the search is stopped; it must
+        // not reach the PV, killers or history
+        if (stopped) {
+            return 0;
+        }
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = move;
+        }
+        if (score > alpha) {
+            alpha = score;
+            updatePrincipalVariation(move, ply);
+        }
+        if (alpha >= beta) {
+            prunedBranches++;
+            updateQuietCutoff(move, currentColor, depth, ply);
+            break;
+        }
+    }
+
+    // A search cut short returns made-up scores, which must not be cached
+    if (config.useTransTable && !stopped) {
+        TranspositionTable::Bound bound = TranspositionTable::BOUND_EXACT;
+        if (bestScore <= alphaOrig) {
+            bound = TranspositionTable::BOUND_UPPER;
+        } else if (bestScore >= beta) {
+            bound = TranspositionTable::BOUND_LOWER;
+        }
+        shared.transTable.store(boardKey, depth, ply, bestScore, bound, bestMove);
+    }
+
+    return bestScore;
+}
+
+int SearchWorker::quiescence(int alpha, int beta, int ply) {
+    quiescenceNodes++;
+
+    if (shouldStop()) {
+        return 0;
+    }
+
+    // Stand pat: the side to move may decline every capture
+    int standPat = evaluate(ply);
+    if (standPat >= beta || ply >= MAX_PLY) {
+        return standPat;
+    }
+    alpha = max(alpha, standPat);
+
+    MovePicker picker(board, sideToMove(ply));
+
+    int bestScore = standPat;
+    PackedMove move;
+    while (picker.next(move)) {
+        // Delta pruning: skip captures that cannot lift the score back into
+        // the window even if the captured piece came for free
+        int gain = Evaluator::getPieceValue(move.getCapturedPiece(board)) + DELTA_MARGIN;
+        if (move.isPromotionMove()) {
+            gain += Evaluator::getPieceValue(QUEEN) - Evaluator::getPieceValue(PAWN);
+        }
+        if (standPat + gain <= alpha) {
+            prunedBranches++;
+            deltaPrunes++;
+            continue;
+        }
+
+        // Captures that lose material on the exchange are not worth resolving
+        if (picker.getScore() < 0) {
+            prunedBranches++;
+            seePrunes++;
+            continue;
+        }
+
+        MoveUndo undo;
+        board.makeMove(move, undo);
+        int score = -quiescence(-beta, -alpha, ply + 1);
+        board.unmakeMove(move, undo);
+
+        if (stopped) {
+            return 0;
+        }
+
+        bestScore = max(bestScore, score);
+        alpha = max(alpha, score);
+        if (alpha >= beta) {
+            prunedBranches++;
+            break;
+        }
+    }
+
+    return bestScore;
+}
+
+Color SearchWorker::sideToMove(int ply) const {
+    return (ply % 2 == 0) ? shared.color : oppositeColor(shared.color);
+}
+
+bool SearchWorker::hasNonPawnMaterial(Color color) const {
+    return board.countPieces(color) - board.countPieceType(PAWN, color) > 1;
+}
+
+
+int SearchWorker::evaluate(int ply) const {
+    Color color = sideToMove(ply);
+    if (shared.config.useAdvancedEval) {
+        return Evaluator::evaluate(board, color);
+    }
+    return Evaluator::evaluateMaterial(board) * (color == WHITE ? 1 : -1);
+}
+
+bool SearchWorker::shouldStop() {
+    if (stopped) {
+        return true;
+    }
+
+    // Budgets are checked every 1024 nodes; reading the clock and touching the
+    // shared counter on every node would cost more than the check is worth
+    int local = nodes + quiescenceNodes;
+    if ((local & 1023) == 0) {
+        const DifficultyConfig& config = shared.config;
+        int total = shared.nodes.fetch_add(local - flushedNodes, memory_order_relaxed) + local - flushedNodes;
+        flushedNodes = local;
+
+        if (!shared.pondering.load(memory_order_relaxed) &&
+            ((config.nodeLimit > 0 && total >= config.nodeLimit) ||
+             (config.timeLimitMs > 0 && elapsedMs() >= config.timeLimitMs))) {
+            shared.stop.store(true, memory_order_relaxed);
+        }
+    }
+
+    stopped = shared.stop.load(memory_order_relaxed);
+    return stopped;
+}
+
+int SearchWorker::elapsedMs() const {
+    return static_cast<int>(chrono::duration_cast<chrono::milliseconds>(
+        chrono::steady_clock::now() - shared.start).count());
+}
+
+void SearchWorker::updateQuietCutoff(PackedMove move, Color color, int depth, int ply) {
+    if (move.getCapturedPiece(board) != EMPTY || move.isPromotionMove()) {
+        return;
+    }
+
+    if (ply < MAX_PLY && killers[ply][0] != move) {
+        killers[ply][1] = killers[ply][0];
+        killers[ply][0] = move;
+    }
+
+    int& score = history[color - 1][move.getFromSquare()][move.getToSquare()];
+    score += depth * depth;
+    if (score >= HISTORY_LIMIT) {
+        for (auto& from : history[color - 1]) {
+            for (int& entry : from) {
+                entry /= 2;
+            }
+        }
+    }
+}
+
+void SearchWorker::updatePrincipalVariation(PackedMove move, int ply) {
+    pvTable[ply][ply] = move;
+    int length = (ply + 1 < MAX_PLY) ? pvLength[ply + 1] : ply + 1;
+    for (int i = ply + 1; i < length; i++) {
+        pvTable[ply][i] = pvTable[ply + 1][i];
+    }
+    pvLength[ply] = max(length, ply + 1);
+}
+
+void SearchWorker::orderMoves(MoveList& moves, const Board& board) {
+    // Scores are computed once, then the moves sorted alongside them
+    int scores[MoveList::CAPACITY];
+    for (int i = 0; i < moves.size(); i++) {
+        bool tactical = moves[i].getCapturedPiece(board) != EMPTY || moves[i].isPromotionMove();
+        scores[i] = tactical ? MovePicker::captureScore(board, moves[i]) : 0;
+    }
+
+    for (int i = 1; i < moves.size(); i++) {
+        PackedMove move = moves[i];
+        int score = scores[i];
+        int j = i;
+        for (; j > 0 && scores[j - 1] < score; j--) {
+            moves[j] = moves[j - 1];
+            scores[j] = scores[j - 1];
+        }
+        moves[j] = move;
+        scores[j] = score;
+    }
+}
+
+PackedMove SearchWorker::getBestMove() const {
+    return bestMove;
+}
+
+int SearchWorker::getBestScore() const {
+    return bestScore;
+}
+
+const MoveList& SearchWorker::getPrincipalVariation() const {
+    return principalVariation;
+}
+
+int SearchWorker::getCompletedDepth() const {
+    return completedDepth;
+}
+
+int SearchWorker::getNodes() const {
+    return nodes;
+}
+
+int SearchWorker::getQuiescenceNodes() const {
+    return quiescenceNodes;
+}
+
+int SearchWorker::getCacheHits() const {
+    return cacheHits;
+}
+
+int SearchWorker::getPrunedBranches() const {
+    return prunedBranches;
+}
+
+int SearchWorker::getNullMoveCutoffs() const {
+    return nullMoveCutoffs;
+}
+
+int SearchWorker::getFutilityPrunes() const {
+    return futilityPrunes;
+}
+
+int SearchWorker::getRazorPrunes() const {
+    return razorPrunes;
+}
+
+int SearchWorker::getDeltaPrunes() const {
+    return deltaPrunes;
+}
+
+int SearchWorker::getSeePrunes() const {
+    return seePrunes;
+}
+
+int SearchWorker::getBitbaseDraws() const {
+    return bitbaseDraws;
+}
+
+int SearchWorker::getTableProbes() const {
+    return tableProbes;
+}
+
+int SearchWorker::getTableHits() const {
+    return tableHits;
+}
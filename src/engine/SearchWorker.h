@@ -0,0 +1,143 @@
+#ifndef SEARCHWORKER_H
+#define SEARCHWORKER_H
+
+#include "../core/Board.h"
+#include "../core/MoveList.h"
+#include "AI.h"
+#include "TranspositionTable.h"
+#include <atomic>
+#include <chrono>
+
+using namespace std;
+
+// State every search thread shares: the hash table, the budget and the stop flag
+struct SearchShared {
+    TranspositionTable& transTable;
+    DifficultyConfig config;
+    Color color;                // side the AI plays, to move at the root
+    bool silent;
+    chrono::steady_clock::time_point start;
+    atomic<bool> stop;
+    atomic<int> nodes;          // all threads' nodes, flushed every 1024 nodes
+    // Set while searching on the opponent's time: the budget is ignored until
+    // a ponder hit clears it, then counts from the start of pondering
+    atomic<bool> pondering;
+
+    SearchShared(TranspositionTable& table, const DifficultyConfig& config, Color color, bool silent,
+                 bool pondering = false)
+        : transTable(table), config(config), color(color), silent(silent),
+          start(chrono::steady_clock::now()), stop(false), nodes(0), pondering(pondering) {}
+};
+
+// One search thread. Worker 0 is the main thread and decides when the search
+// ends; helpers run the same iterative deepening with varied depths and root
+// move orders, and mainly help by filling the shared transposition table.
+class SearchWorker {
+public:
+    static const int MATE_SCORE = 20000;
+    // Above any reachable score; kept small enough to negate safely
+    static const int INFINITE_SCORE = 30000;
+    // Half-width of the first window around the previous iteration's score
+    static const int ASPIRATION_WINDOW = 50;
+    static const int ASPIRATION_DEPTH = 4;
+    // Slack for positional gains when delta pruning quiescence captures
+    static const int DELTA_MARGIN = 200;
+    // Futility pruning and razoring run at depths 1 to FRONTIER_DEPTH; a
+    // quiet move is futile when the eval plus FUTILITY_MARGIN per ply of
+    // depth stays at or below alpha
+    static const int FRONTIER_DEPTH = 3;
+    static const int FUTILITY_MARGIN = 150;
+    static const int RAZOR_MARGIN = 300;
+    // Deepest ply that keeps killer moves
+    static const int MAX_PLY = 128;
+    // History scores are halved once one reaches this, so they stay below killers
+    static const int HISTORY_LIMIT = 1 << 16;
+
+    SearchWorker(int id, SearchShared& shared);
+
+    // Iterative deepening over rootMoves until the maximum depth or a stop
+    void search(const Board& root, const MoveList& rootMoves);
+
+    // Best move, score (for the AI's side) and expected line of the last
+    // completed iteration
+    PackedMove getBestMove() const;
+    int getBestScore() const;
+    const MoveList& getPrincipalVariation() const;
+    int getCompletedDepth() const;
+
+    int getNodes() const;
+    int getQuiescenceNodes() const;
+    int getCacheHits() const;
+    int getPrunedBranches() const;
+    int getNullMoveCutoffs() const;
+    int getFutilityPrunes() const;
+    int getRazorPrunes() const;
+    int getDeltaPrunes() const;
+    int getSeePrunes() const;
+    int getBitbaseDraws() const;
+    int getTableProbes() const;
+    int getTableHits() const;
+
+    // Winning and even captures first by MVV-LVA, then the other moves in
+    // their order, then losing captures
+    static void orderMoves(MoveList& moves, const Board& board);
+
+private:
+    int id;
+    SearchShared& shared;
+    Board board;
+
+    PackedMove bestMove;
+    int bestScore;
+    int completedDepth;
+    MoveList principalVariation;
+    bool stopped;
+
+    int nodes;
+    int quiescenceNodes;
+    int flushedNodes;
+    int cacheHits;
+    int prunedBranches;         // every cutoff and pruned move, broken down below
+    int nullMoveCutoffs;
+    int futilityPrunes;
+    int razorPrunes;
+    int deltaPrunes;
+    int seePrunes;
+    int bitbaseDraws;
+    int tableProbes;
+    int tableHits;
+
+    // Quiet moves that caused a beta cutoff, two per ply, and how often each
+    // quiet from-to pair has cut off anywhere, weighted by depth
+    PackedMove killers[MAX_PLY][2];
+    int history[2][64][64];
+
+    // Triangular PV table: pvTable[ply] holds the best line found from ply,
+    // ending at pvLength[ply]
+    PackedMove pvTable[MAX_PLY][MAX_PLY];
+    int pvLength[MAX_PLY];
+
+    void updateQuietCutoff(PackedMove move, Color color, int depth, int ply);
+    void updatePrincipalVariation(PackedMove move, int ply);
+
+    // Principal variation search over the root moves in one window; moves
+    // the best root move to the front
+    int searchRoot(MoveList& moves, int depth, int alpha, int beta);
+    // Negamax: scores are for the side to move, which is the AI's side at
+    // even plies. ply is the distance from the root, mate scores are
+    // MATE_SCORE - ply. allowNullMove is false right after a null move.
+    int negamax(int depth, int alpha, int beta, int ply, bool allowNullMove);
+    // Searches captures and promotions only, until the position is quiet
+    int quiescence(int alpha, int beta, int ply);
+
+    Color sideToMove(int ply) const;
+    // False when the side has only pawns and king, where zugzwang is common
+    // and passing the turn is not a safe lower bound
+    bool hasNonPawnMaterial(Color color) const;
+    // Static evaluation for the side to move
+    int evaluate(int ply) const;
+    bool shouldStop();
+    int elapsedMs() const;
+};
+
+#endif // SEARCHWORKER_H
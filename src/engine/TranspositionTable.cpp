@@ -3,61 +3,150 @@
 
 using namespace std;
 
-TranspositionTable::TranspositionTable(int maxSize) {
-    this->maxSize = maxSize;
-    hits = 0;
-    misses = 0;
+namespace {
+
+const int AGE_BITS = 6;
+const uint8_t AGE_MASK = (1 << AGE_BITS) - 1;
+
+PackedMove dataMove(uint64_t data) {
+    return PackedMove::fromRaw(static_cast<uint16_t>(data));
 }
 
-void TranspositionTable::store(const string &boardKey, int evaluation) {
-    if (table.size() >= static_cast<size_t>(maxSize)) {
-        clear();
-    }
+int dataScore(uint64_t data) {
+    return static_cast<int16_t>(data >> 16);
+}
 
-    table[boardKey] = evaluation;
+int dataDepth(uint64_t data) {
+    return static_cast<int>((data >> 32) & 0xFF);
 }
 
-bool TranspositionTable::lookup(const string &boardKey, int &evaluation) {
-    auto it = table.find(boardKey);
-    if (it != table.end()) {
-        evaluation = it->second;
-        hits++;
-        return true;
-    }
+TranspositionTable::Bound dataBound(uint64_t data) {
+    return static_cast<TranspositionTable::Bound>((data >> 40) & 0x3);
+}
 
-    misses++;
-    return false;
+uint8_t dataAge(uint64_t data) {
+    return static_cast<uint8_t>((data >> 42) & AGE_MASK);
 }
 
-bool TranspositionTable::contains(const string &boardKey) const {
-    return table.find(boardKey) != table.end();
+} // namespace
+
+TranspositionTable::TranspositionTable(int sizeMB) {
+    bucketCount = 0;
+    bucketMask = 0;
+    age = 0;
+    resize(sizeMB);
+}
+
+void TranspositionTable::resize(int sizeMB) {
+    uint64_t bytes = static_cast<uint64_t>(sizeMB < 1 ? 1 : sizeMB) << 20;
+    uint64_t count = 1;
+    while (count * 2 * sizeof(Bucket) <= bytes) {
+        count *= 2;
+    }
+
+    buckets.reset(new Bucket[count]);
+    bucketCount = count;
+    bucketMask = count - 1;
+    clear();
 }
 
 void TranspositionTable::clear() {
-    table.clear();
-    hits = 0;
-    misses = 0;
+    for (uint64_t i = 0; i < bucketCount; i++) {
+        for (Entry& entry : buckets[i].entries) {
+            entry.check.store(0, memory_order_relaxed);
+            entry.data.store(0, memory_order_relaxed);
+        }
+    }
+    age = 0;
 }
 
-int TranspositionTable::getSize() const {
-    return table.size();
+void TranspositionTable::newSearch() {
+    age = (age + 1) & AGE_MASK;
+}
+
+uint64_t TranspositionTable::pack(PackedMove move, int score, int depth, Bound bound, uint8_t age) {
+    return static_cast<uint64_t>(move.raw()) |
+           (static_cast<uint64_t>(static_cast<uint16_t>(score)) << 16) |
+           (static_cast<uint64_t>(depth & 0xFF) << 32) |
+           (static_cast<uint64_t>(bound) << 40) |
+           (static_cast<uint64_t>(age & AGE_MASK) << 42);
 }
 
-int TranspositionTable:: getHits() const {
-    return hits;
+void TranspositionTable::store(uint64_t boardKey, int depth, int ply, int score, Bound bound, PackedMove bestMove) {
+    Bucket& bucket = buckets[boardKey & bucketMask];
+
+    // Mate scores count plies from the root, the table keeps them relative to this node
+    if (score > MATE_THRESHOLD) {
+        score += ply;
+    } else if (score < -MATE_THRESHOLD) {
+        score -= ply;
+    }
+    if (score > INT16_MAX) score = INT16_MAX;
+    if (score < INT16_MIN) score = INT16_MIN;
+    if (depth < 0) depth = 0;
+    if (depth > 255) depth = 255;
+
+    // Reuse the entry for the same position, otherwise evict the shallowest,
+    // counting every search an entry has sat unused as a lost ply of depth
+    Entry* replace = &bucket.entries[0];
+    int replaceValue = 1 << 30;
+    for (Entry& entry : bucket.entries) {
+        uint64_t data = entry.data.load(memory_order_relaxed);
+        if ((entry.check.load(memory_order_relaxed) ^ data) == boardKey) {
+            replace = &entry;
+            if (bestMove.isNull()) {
+                bestMove = dataMove(data);
+            }
+            break;
+        }
+
+        int entryAge = (age - dataAge(data)) & AGE_MASK;
+        int value = (data == 0) ? -(1 << 20) : dataDepth(data) - 8 * entryAge;
+        if (value < replaceValue) {
+            replaceValue = value;
+            replace = &entry;
+        }
+    }
+
+    uint64_t data = pack(bestMove, score, depth, bound, age);
+    replace->data.store(data, memory_order_relaxed);
+    replace->check.store(boardKey ^ data, memory_order_relaxed);
 }
 
-int TranspositionTable::getMisses() const {
-    return misses;
+bool TranspositionTable::probe(uint64_t boardKey, int ply, ProbeResult &result) {
+    Bucket& bucket = buckets[boardKey & bucketMask];
+
+    for (const Entry& entry : bucket.entries) {
+        uint64_t data = entry.data.load(memory_order_relaxed);
+        if (data == 0 || (entry.check.load(memory_order_relaxed) ^ data) != boardKey) {
+            continue;
+        }
+
+        int score = dataScore(data);
+        if (score > MATE_THRESHOLD) {
+            score -= ply;
+        } else if (score < -MATE_THRESHOLD) {
+            score += ply;
+        }
+
+        result.score = score;
+        result.depth = dataDepth(data);
+        result.bound = dataBound(data);
+        result.bestMove = dataMove(data);
+        return true;
+    }
+
+    return false;
 }
 
-float TranspositionTable::getHitRate() const {
-    int total = hits + misses;
-    if (total == 0) return 0.0f; 
+int TranspositionTable::getSize() const {
+    return static_cast<int>(bucketCount * 4);
+}
 
-    return (float)hits / total * 100.0f; // "f" to indicate float literal
+int TranspositionTable::getSizeMB() const {
+    return static_cast<int>((bucketCount * sizeof(Bucket)) >> 20);
 }
 
-string TranspositionTable::generateKey(const Board& board) {
-    return board.toString();
+uint64_t TranspositionTable::generateKey(const Board& board) {
+    return board.getZobristKey();
 }
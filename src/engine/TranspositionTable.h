@@ -2,34 +2,79 @@
 #define TRANSPOSITIONTABLE_H
 
 #include "../utils/Types.h"
-#include <unordered_map>
-#include <string>
+#include <atomic>
+#include <memory>
+#include <cstdint>
 #include "../core/Board.h"
+#include "../core/PackedMove.h"
 
 using namespace std;
 
+// Fixed-size hash table of search results. The table is a power-of-two array
+// of 64-byte buckets, each holding four 16-byte entries, so a probe touches a
+// single cache line. Nothing is allocated or freed while searching.
+// Search threads share it without locks: an entry stores key ^ data next to
+// data, so an entry torn by two threads writing at once fails verification.
 class TranspositionTable
 {
+public:
+    enum Bound
+    {
+        BOUND_NONE = 0,
+        BOUND_UPPER = 1,    // score is at most this (failed low)
+        BOUND_LOWER = 2,    // score is at least this (failed high)
+        BOUND_EXACT = 3
+    };
+
+    // Scores beyond this are mate scores, stored relative to the node's ply
+    static const int MATE_THRESHOLD = 19000;
+
+    struct ProbeResult
+    {
+        int score;
+        int depth;
+        Bound bound;
+        PackedMove bestMove;
+    };
+
 private:
-    unordered_map<string, int> table;
+    // data packs move (16) | score (16) | depth (8) | bound (2) | age (6)
+    struct Entry
+    {
+        atomic<uint64_t> check;     // key ^ data
+        atomic<uint64_t> data;
+    };
+
+    struct alignas(64) Bucket
+    {
+        Entry entries[4];
+    };
 
-    int maxSize;
-    int hits;
-    int misses;
+    unique_ptr<Bucket[]> buckets;
+    uint64_t bucketCount;
+    uint64_t bucketMask;
+    uint8_t age;
+
+    static uint64_t pack(PackedMove move, int score, int depth, Bound bound, uint8_t age);
 
 public:
-    TranspositionTable(int maxSize = 100000);
-    
-    void store(const string &boardKey, int evaluation);
-    bool lookup(const string &boardKey, int &evaluation);
-    bool contains(const string &boardKey) const;
+    TranspositionTable(int sizeMB = 16);
+
+    // Reallocates to the largest power-of-two bucket count fitting in sizeMB
+    void resize(int sizeMB);
     void clear();
 
+    // Called once per search, before the threads start, so entries from
+    // earlier searches get replaced first
+    void newSearch();
+
+    // ply is the distance from the root, used to store mate scores relative to the node
+    void store(uint64_t boardKey, int depth, int ply, int score, Bound bound, PackedMove bestMove);
+    bool probe(uint64_t boardKey, int ply, ProbeResult &result);
+
     int getSize() const;
-    int getHits() const;
-    int getMisses() const;
-    float getHitRate() const;
+    int getSizeMB() const;
 
-    static string generateKey(const Board& board);
+    static uint64_t generateKey(const Board& board);
 };
-#endif // TRANSPOSITIONTABLE_H
\ No newline at end of file
+#endif // TRANSPOSITIONTABLE_H
@@ -1,70 +1,142 @@
 #include "../core/ChessAPI.h"
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
 
 using namespace std;
 
-int main(int argc, char* argv[]) {
-    if (argc < 2) {
-        cerr << "{\"error\":\"Usage: chess_cli <command> [args...]\"}" << endl;
-        return 1;
-    }
-    
-    // CRITICAL: Static to maintain state between CLI calls
-    static ChessAPI api;
-    
-    string command = argv[1];
+// Runs one command (args[0]) and writes its JSON reply; returns the exit code
+static int runCommand(ChessAPI& api, const vector<string>& args, ostream& out, ostream& err) {
+    const string& command = args[0];
     
     try {
         if (command == "newgame") {
             api.newGame();
-            cout << "{\"success\":true}" << endl;
+            out << "{\"success\":true}" << endl;
         }
         else if (command == "setai") {
-            if (argc < 3) {
-                cerr << "{\"error\":\"Missing difficulty\"}" << endl;
+            // setai <difficulty> [timeMs] [nodes] [threads]
+            if (args.size() < 2) {
+                err << "{\"error\":\"Missing difficulty\"}" << endl;
                 return 1;
             }
-            api.setAI(argv[2]);
-            cout << "{\"success\":true}" << endl;
+            int timeMs = args.size() > 2 ? stoi(args[2]) : 0;
+            int nodes = args.size() > 3 ? stoi(args[3]) : 0;
+            int threads = args.size() > 4 ? stoi(args[4]) : 1;
+            api.setAI(args[1], timeMs, nodes, threads);
+            out << "{\"success\":true}" << endl;
         }
         else if (command == "move") {
-            if (argc < 4) {
-                cerr << "{\"error\":\"Missing from/to positions\"}" << endl;
+            if (args.size() < 3) {
+                err << "{\"error\":\"Missing from/to positions\"}" << endl;
                 return 1;
             }
-            bool success = api.makeMove(argv[2], argv[3]);
-            cout << "{\"success\":" << (success ? "true" : "false") << "}" << endl;
+            bool success = api.makeMove(args[1], args[2]);
+            out << "{\"success\":" << (success ? "true" : "false") << "}" << endl;
         }
         else if (command == "aimove") {
-            cout << api.getAIMove() << endl;
+            out << api.getAIMove() << endl;
         }
         else if (command == "undo") {
             bool success = api.undoMove();
-            cout << "{\"success\":" << (success ? "true" : "false") << "}" << endl;
+            out << "{\"success\":" << (success ? "true" : "false") << "}" << endl;
         }
         else if (command == "board") {
-            cout << api.getBoardJSON() << endl;
+            out << api.getBoardJSON() << endl;
         }
         else if (command == "status") {
-            cout << api.getGameStatusJSON() << endl;
+            out << api.getGameStatusJSON() << endl;
         }
         else if (command == "validmoves") {
-            if (argc < 3) {
-                cerr << "{\"error\":\"Missing position\"}" << endl;
+            if (args.size() < 2) {
+                err << "{\"error\":\"Missing position\"}" << endl;
+                return 1;
+            }
+            out << api.getValidMovesJSON(args[1]) << endl;
+        }
+        else if (command == "perft") {
+            // perft <depth> [threads] [fen...]
+            if (args.size() < 2) {
+                err << "{\"error\":\"Missing depth\"}" << endl;
+                return 1;
+            }
+            int depth = stoi(args[1]);
+            int threads = 1;
+            size_t fenStart = 2;
+            if (args.size() > 2 && args[2].find_first_not_of("0123456789") == string::npos) {
+                threads = stoi(args[2]);
+                fenStart = 3;
+            }
+            string fen;
+            for (size_t i = fenStart; i < args.size(); i++) {
+                if (!fen.empty()) fen += " ";
+                fen += args[i];
+            }
+            out << api.getPerftJSON(depth, threads, fen) << endl;
+        }
+        else if (command == "buildbook") {
+            // buildbook <pgn> <book> [maxPly]
+            if (args.size() < 3) {
+                err << "{\"error\":\"Missing PGN or book path\"}" << endl;
                 return 1;
             }
-            cout << api.getValidMovesJSON(argv[2]) << endl;
+            int maxPly = args.size() > 3 ? stoi(args[3]) : 16;
+            out << api.buildBookJSON(args[1], args[2], maxPly) << endl;
+        }
+        else if (command == "buildbitbases") {
+            // buildbitbases [path] [threads]
+            string path = args.size() > 1 ? args[1] : "";
+            int threads = args.size() > 2 ? stoi(args[2]) : static_cast<int>(thread::hardware_concurrency());
+            out << api.buildBitbasesJSON(path, threads) << endl;
         }
         else {
-            cerr << "{\"error\":\"Unknown command: " << command << "\"}" << endl;
+            err << "{\"error\":\"Unknown command: " << command << "\"}" << endl;
             return 1;
         }
     }
     catch (const exception& e) {
-        cerr << "{\"error\":\"" << e.what() << "\"}" << endl;
+        err << "{\"error\":\"" << e.what() << "\"}" << endl;
         return 1;
     }
     
     return 0;
-}
\ No newline at end of file
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        cerr << "{\"error\":\"Usage: chess_cli <command> [args...]\"}" << endl;
+        return 1;
+    }
+    
+    // CRITICAL: Static to maintain state between CLI calls
+    static ChessAPI api;
+    
+    // serve: stay alive and read one command per line from stdin, answering
+    // each with one line of JSON on stdout. Keeping the process (and the AI)
+    // alive is what lets the AI ponder on the opponent's time.
+    if (string(argv[1]) == "serve") {
+        api.setPondering(true);
+        string line;
+        while (getline(cin, line)) {
+            vector<string> args;
+            istringstream words(line);
+            string word;
+            while (words >> word) {
+                args.push_back(word);
+            }
+            if (args.empty()) {
+                continue;
+            }
+            if (args[0] == "quit") {
+                break;
+            }
+            runCommand(api, args, cout, cout);
+            cout.flush();
+        }
+        return 0;
+    }
+    
+    return runCommand(api, vector<string>(argv + 1, argv + argc), cout, cerr);
+}
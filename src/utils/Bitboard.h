@@ -0,0 +1,95 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include "Types.h"
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// One bit per square, bit index = row * 8 + col (a1 = 0, h8 = 63)
+typedef uint64_t Bitboard;
+
+const Bitboard EMPTY_BB = 0ULL;
+const Bitboard ALL_SQUARES_BB = ~0ULL;
+
+const Bitboard FILE_A_BB = 0x0101010101010101ULL;
+const Bitboard FILE_H_BB = FILE_A_BB << 7;
+const Bitboard RANK_1_BB = 0xFFULL;
+const Bitboard RANK_8_BB = RANK_1_BB << 56;
+
+inline int squareIndex(int row, int col) {
+    return row * 8 + col;
+}
+
+inline int squareIndex(Position pos) {
+    return pos.row * 8 + pos.col;
+}
+
+inline Position squareToPosition(int square) {
+    return Position(square / 8, square % 8);
+}
+
+inline Bitboard squareBB(int square) {
+    return 1ULL << square;
+}
+
+inline int popCount(Bitboard bb) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    return static_cast<int>(__popcnt64(bb));
+#elif defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(bb);
+#else
+    int count = 0;
+    while (bb) {
+        bb &= bb - 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+// Index of the lowest set bit, bb must not be empty
+inline int lsbIndex(Bitboard bb) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, bb);
+    return static_cast<int>(index);
+#elif defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(bb);
+#else
+    int index = 0;
+    while (!(bb & 1ULL)) {
+        bb >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+// Index of the highest set bit, bb must not be empty
+inline int msbIndex(Bitboard bb) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanReverse64(&index, bb);
+    return static_cast<int>(index);
+#elif defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(bb);
+#else
+    int index = 0;
+    while (bb >>= 1) {
+        index++;
+    }
+    return index;
+#endif
+}
+
+// Removes the lowest set bit and returns its index
+inline int popLsb(Bitboard& bb) {
+    int index = lsbIndex(bb);
+    bb &= bb - 1;
+    return index;
+}
+
+#endif // BITBOARD_H
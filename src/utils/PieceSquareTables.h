@@ -0,0 +1,115 @@
+#ifndef PIECESQUARETABLES_H
+#define PIECESQUARETABLES_H
+
+#include "Types.h"
+
+// Material values and middlegame/endgame piece-square bonuses, indexed by
+// piece type and square from white's side (a1 = 0). Black looks up the
+// rank-mirrored square. The tables are generated at compile time from the
+// placement rules below.
+//
+// Each piece also carries a phase weight; their sum over the board, capped
+// at MAX_PHASE, says how far the game is from the endgame and is what the
+// evaluator interpolates the two bonuses with.
+struct PieceSquareData {
+    int value[7];
+    int phase[7];
+    int middlegame[7][64];
+    int endgame[7][64];
+};
+
+// Steps from the four centre squares: 0 on d4-e5, 3 on the edge
+constexpr int centerDistance(int row, int col) {
+    int rowDistance = row < 4 ? 3 - row : row - 4;
+    int colDistance = col < 4 ? 3 - col : col - 4;
+    return rowDistance > colDistance ? rowDistance : colDistance;
+}
+
+constexpr int middlegameRule(PieceType type, int row, int col) {
+    int center = centerDistance(row, col);
+    bool centerFile = col == 3 || col == 4;
+    switch (type) {
+        case PAWN:
+            // Advance, and occupy the centre with the d and e pawns
+            return row * 5 + (centerFile && (row == 3 || row == 4) ? 15 : 0);
+        case KNIGHT:
+            return 20 - 8 * center;
+        case BISHOP:
+            return 10 - 5 * center + (row == col || row + col == 7 ? 5 : 0);
+        case ROOK:
+            return (row == 6 ? 15 : 0) + (centerFile ? 5 : 0);
+        case QUEEN:
+            return center <= 1 ? 5 : 0;
+        case KING:
+            // Stay home behind the pawns, preferably castled
+            if (row == 0) return (col <= 2 || col >= 6) ? 20 : 0;
+            return -15 * row;
+        default:
+            return 0;
+    }
+}
+
+constexpr int endgameRule(PieceType type, int row, int col) {
+    int center = centerDistance(row, col);
+    switch (type) {
+        case PAWN:
+            // Passed or not, every step brings promotion closer
+            return row * 12;
+        case KNIGHT:
+            return 15 - 8 * center;
+        case BISHOP:
+            return 8 - 4 * center;
+        case ROOK:
+            return row == 6 ? 15 : 0;
+        case QUEEN:
+            return 10 - 5 * center;
+        case KING:
+            // With the queens gone the king is a fighting piece
+            return 15 - 10 * center;
+        default:
+            return 0;
+    }
+}
+
+constexpr PieceSquareData generatePieceSquareData() {
+    PieceSquareData data{};
+    const int values[7] = {0, 100, 320, 330, 500, 900, 20000};
+    const int phases[7] = {0, 0, 1, 1, 2, 4, 0};
+    for (int type = PAWN; type <= KING; type++) {
+        data.value[type] = values[type];
+        data.phase[type] = phases[type];
+        for (int square = 0; square < 64; square++) {
+            PieceType piece = static_cast<PieceType>(type);
+            data.middlegame[type][square] = middlegameRule(piece, square / 8, square % 8);
+            data.endgame[type][square] = endgameRule(piece, square / 8, square % 8);
+        }
+    }
+    return data;
+}
+
+class PieceSquareTables {
+public:
+    // Phase of the starting position: four minor pieces, two rooks and a queen a side
+    static const int MAX_PHASE = 24;
+
+    static int value(PieceType type) {
+        return DATA.value[type];
+    }
+
+    static int phase(PieceType type) {
+        return DATA.phase[type];
+    }
+
+    static int middlegame(PieceType type, Color color, int square) {
+        return DATA.middlegame[type][color == WHITE ? square : square ^ 56];
+    }
+
+    static int endgame(PieceType type, Color color, int square) {
+        return DATA.endgame[type][color == WHITE ? square : square ^ 56];
+    }
+
+private:
+    static constexpr PieceSquareData DATA = generatePieceSquareData();
+};
+
+#endif // PIECESQUARETABLES_H
@@ -0,0 +1,56 @@
+const test = require('node:test');
+const assert = require('node:assert');
+const { spawn } = require('child_process');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const readline = require('readline');
+
+// The chess CLI built next to server.js's default path, or the one in CHESS_CLI
+const CLI_PATH = process.env.CHESS_CLI ||
+    path.resolve(__dirname, '..', process.platform === 'win32' ? 'chess_cli.exe' : 'chess_cli');
+
+// Sends the commands to one "serve" process and collects every stdout line
+function serve(commands) {
+    return new Promise((resolve, reject) => {
+        // A scratch directory, so the session file of a real game is left alone
+        const cwd = fs.mkdtempSync(path.join(os.tmpdir(), 'chess-serve-'));
+        const engine = spawn(CLI_PATH, ['serve'], { cwd });
+        const lines = [];
+        readline.createInterface({ input: engine.stdout }).on('line', (line) => lines.push(line));
+        engine.stderr.resume();
+        engine.on('error', reject);
+        engine.on('close', () => {
+            fs.rmSync(cwd, { recursive: true, force: true });
+            resolve(lines);
+        });
+        engine.stdin.end(commands.join('\n') + '\nquit\n');
+    });
+}
+
+test('serve answers every command with exactly one JSON line',
+    { skip: !fs.existsSync(CLI_PATH) && `chess_cli not built at ${CLI_PATH}` },
+    async () => {
+        const lines = await serve([
+            'newgame',
+            // Fool's mate, then a move after the game is over
+            'move f2 f3', 'move e7 e5', 'move g2 g4', 'move d8 h4',
+            'move a2 a3',
+            'status',
+            // Undo with no moves made
+            'newgame',
+            'undo',
+            'status'
+        ]);
+
+        const replies = lines.map((line) => JSON.parse(line));
+        assert.strictEqual(replies.length, 10);
+        assert.deepStrictEqual(replies.slice(0, 5), Array(5).fill({ success: true }));
+        assert.deepStrictEqual(replies[5], { success: false });
+        assert.strictEqual(replies[6].isCheckmate, true);
+        assert.strictEqual(replies[6].moveCount, 4);
+        assert.deepStrictEqual(replies[7], { success: true });
+        assert.deepStrictEqual(replies[8], { success: false });
+        assert.strictEqual(replies[9].isGameOver, false);
+        assert.strictEqual(replies[9].moveCount, 0);
+    });